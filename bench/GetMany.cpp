@@ -0,0 +1,69 @@
+// Compares reading a component of many entities in a random order one by one with BasicWorld::GetMany.
+// Not part of the CMake build, compile it with optimizations, e.g.
+// g++ -std=c++17 -O2 -I../include GetMany.cpp -o GetMany
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <FluffECS/World.h>
+
+struct Position
+{
+	float x, y, z, w;
+};
+
+struct Health
+{
+	int value;
+};
+
+struct Armor
+{
+	int value;
+};
+
+int main()
+{
+	constexpr int N_ENTITIES = 2'000'000;
+	constexpr int N_REPETITIONS = 3;
+	
+	flf::World myWorld{};
+	std::vector<flf::EntityId> ids{};
+	ids.reserve(N_ENTITIES);
+	// spread the entities over multiple Archetypes, like the targets referenced by other entities
+	for (int i = 0; i < N_ENTITIES; ++i)
+	{
+		const float x = float(i);
+		if (i % 3 == 0)
+		{
+			ids.push_back(myWorld.CreateEntity(Position{x, 0, 0, 0}).Id());
+		} else if (i % 3 == 1)
+		{
+			ids.push_back(myWorld.CreateEntity(Position{x, 0, 0, 0}, Health{i}).Id());
+		} else
+		{
+			ids.push_back(myWorld.CreateEntity(Position{x, 0, 0, 0}, Armor{i}).Id());
+		}
+	}
+	std::shuffle(ids.begin(), ids.end(), std::mt19937(1));
+	
+	std::vector<Position> positions(ids.size());
+	for (int repetition = 0; repetition < N_REPETITIONS; ++repetition)
+	{
+		const auto begin = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < ids.size(); ++i)
+		{
+			positions[i] = *myWorld.GetEntity(ids[i]).Get<Position>();
+		}
+		const auto single = std::chrono::steady_clock::now();
+		myWorld.GetMany(ids.data(), ids.size(), positions.data());
+		const auto batched = std::chrono::steady_clock::now();
+		
+		std::printf("one by one: %.1f ms, GetMany: %.1f ms (checksum %.0f)\n",
+		            std::chrono::duration<double, std::milli>(single - begin).count(),
+		            std::chrono::duration<double, std::milli>(batched - single).count(), positions[5].x);
+	}
+	myWorld.DestroyAll<Position>();
+	return 0;
+}
@@ -0,0 +1,168 @@
+// Compares Foreach over a world using HugePageResource with the default memory resource. On Linux the page faults
+// and, where the hardware counters are available, the dTLB load misses of each pass are counted as well.
+// Not part of the CMake build, compile it with optimizations, e.g.
+// g++ -std=c++17 -O2 -I../include HugePages.cpp -o HugePages
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <FluffECS/World.h>
+#include <FluffECS/HugePageResource.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct Position
+{
+	float x, y, z;
+};
+
+struct Velocity
+{
+	float dx, dy, dz;
+};
+
+/// Counts an event of the calling thread, or reports it as unavailable
+class Counter
+{
+public:
+	Counter(std::uint32_t type, std::uint64_t config)
+	{
+#ifdef __linux__
+		perf_event_attr attributes{};
+		attributes.size = sizeof(attributes);
+		attributes.type = type;
+		attributes.config = config;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		_fd = int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+		(void) type;
+		(void) config;
+#endif
+	}
+	
+	Counter(const Counter &) = delete;
+	
+	Counter &operator=(const Counter &) = delete;
+	
+	~Counter()
+	{
+#ifdef __linux__
+		if (_fd >= 0)
+		{
+			close(_fd);
+		}
+#endif
+	}
+	
+	/// \return the current count, or -1 if the event cannot be counted
+	long long Read() const
+	{
+		long long count = -1;
+#ifdef __linux__
+		if (_fd < 0 || read(_fd, &count, sizeof(count)) != sizeof(count))
+		{
+			return -1;
+		}
+#endif
+		return count;
+	}
+
+private:
+	int _fd = -1;
+};
+
+#ifdef __linux__
+constexpr std::uint32_t SOFTWARE = PERF_TYPE_SOFTWARE;
+constexpr std::uint64_t PAGE_FAULTS = PERF_COUNT_SW_PAGE_FAULTS;
+constexpr std::uint32_t HW_CACHE = PERF_TYPE_HW_CACHE;
+constexpr std::uint64_t DTLB_LOAD_MISSES = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+#else
+constexpr std::uint32_t SOFTWARE = 0;
+constexpr std::uint64_t PAGE_FAULTS = 0;
+constexpr std::uint32_t HW_CACHE = 0;
+constexpr std::uint64_t DTLB_LOAD_MISSES = 0;
+#endif
+
+/// \return the anonymous memory of this process backed by transparent huge pages in kB, or -1 if it is not known
+long long AnonHugePagesKb()
+{
+	long long kb = -1;
+#ifdef __linux__
+	if (std::FILE *file = std::fopen("/proc/self/smaps_rollup", "r"))
+	{
+		char line[256];
+		while (std::fgets(line, sizeof(line), file))
+		{
+			if (std::strncmp(line, "AnonHugePages:", 14) == 0)
+			{
+				kb = std::atoll(line + 14);
+			}
+		}
+		std::fclose(file);
+	}
+#endif
+	return kb;
+}
+
+template<typename TWorld>
+void Run(const char *name)
+{
+	constexpr int N_ENTITIES = 4'000'000;
+	constexpr int N_REPETITIONS = 5;
+	
+	const Counter pageFaults{SOFTWARE, PAGE_FAULTS};
+	const Counter tlbMisses{HW_CACHE, DTLB_LOAD_MISSES};
+	
+	TWorld myWorld{};
+	const long long faultsBeforeCreation = pageFaults.Read();
+	const auto beginCreation = std::chrono::steady_clock::now();
+	myWorld.CreateMultiple(N_ENTITIES, Position{0, 0, 0}, Velocity{1, 2, 3});
+	const auto endCreation = std::chrono::steady_clock::now();
+	std::printf("%s: creation %.1f ms, %lld page faults, %lld kB in transparent huge pages\n", name,
+	            std::chrono::duration<double, std::milli>(endCreation - beginCreation).count(),
+	            pageFaults.Read() - faultsBeforeCreation, AnonHugePagesKb());
+	
+	for (int repetition = 0; repetition < N_REPETITIONS; ++repetition)
+	{
+		const long long faultsBefore = pageFaults.Read();
+		const long long missesBefore = tlbMisses.Read();
+		const auto begin = std::chrono::steady_clock::now();
+		myWorld.Foreach([](Position &position, const Velocity &velocity)
+		                {
+			                position.x += velocity.dx;
+			                position.y += velocity.dy;
+			                position.z += velocity.dz;
+		                });
+		const auto end = std::chrono::steady_clock::now();
+		const long long misses = tlbMisses.Read();
+		
+		std::printf("%s: Foreach %.2f ms, %lld page faults, ", name, std::chrono::duration<double, std::milli>(end - begin).count(),
+		            pageFaults.Read() - faultsBefore);
+		if (misses < 0)
+		{
+			std::printf("dTLB load misses n/a\n");
+		} else
+		{
+			std::printf("%lld dTLB load misses\n", misses - missesBefore);
+		}
+	}
+	
+	float checksum = 0;
+	myWorld.Foreach([&](const Position &position) { checksum += position.x; });
+	std::printf("%s: checksum %.0f\n", name, checksum);
+	myWorld.template DestroyAll<Position>();
+}
+
+int main()
+{
+	Run<flf::World>("default");
+	Run<flf::BasicWorld<flf::HugePageResource>>("HugePageResource");
+	return 0;
+}
@@ -1,26 +1,57 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <vector>
 #include <memory_resource>
 #include <type_traits>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <limits>
 
 #include "TypeId.h"
 #include "Entity.h"
 #include "TypeList.h"
 #include "DynamicVector.h"
+#include "ColumnArena.h"
 #include "SparseSet.h"
 #include "VirtualConstructor.h"
 #include "WorldInternal.h"
+#include "Prefab.h"
+#include "MemoryStats.h"
+#include "ChangeStats.h"
 
 namespace flf
 {
+	/// Describes how an Archetype removes single entities
+	enum class RemovalPolicy
+	{
+		/// fills the gap with the last entity. Fast, but changes the iteration order after every removal
+		SwapWithLast,
+		/// leaves a hole that is skipped during iteration until the next Compact(). Keeps the relative order of all entities
+		KeepOrder
+	};
+	
+	/// Describes the algorithm used to sort the entities of an Archetype
+	enum class SortMode
+	{
+		/// a full stable sort, best for unsorted data
+		Full,
+		/// an insertion sort that is close to linear for mostly sorted data, e.g. when sorting every frame
+		Incremental
+	};
+	
 	class Archetype
 	{
 	public:
 		template<typename T> using VectorOf = std::pmr::vector<T>;
 		using IndexType = EntityId;
 
+		/// marks rows in GetIds() that no longer contain an entity
+		static constexpr EntityId HOLE_ID = std::numeric_limits<EntityId>::max();
+
 		/// the number of elements that will be reserved at the construction of the ComponentVector. Does not need to
 		/// be large due to increased efficiency of pmr memory resources
 		static constexpr IndexType VECTOR_PRE_RESERVE_AMOUNT = 32;
@@ -52,8 +83,17 @@ namespace flf
 #ifdef FLUFF_DO_RANGE_CHECKS
 			assert(Contains<TComponent>(entity));
 #endif
-			const auto index = IndexOf(entity);
-			return GetVector<TComponent>().template Get<TComponent>(index);
+			if constexpr (internal::IsEmpty<TComponent>)
+			{
+				// tags have no state, all entities can share the same instance
+				static TComponent tag{};
+				return tag;
+			}
+			if (internal::DynamicVector *vector = GetVector(TypeId<TComponent>())) FLUFF_LIKELY
+			{
+				return vector->template Get<TComponent>(IndexOf(entity));
+			}
+			return _group->template Get<TComponent>(entity);
 		}
 
 		/// Gets the Component part of an entity
@@ -66,9 +106,48 @@ namespace flf
 #ifdef FLUFF_DO_RANGE_CHECKS
 			assert(Contains<TComponent>(entity));
 #endif
-			return GetVector<TComponent>().template Get<TComponent>(IndexOf(entity));
+			if constexpr (internal::IsEmpty<TComponent>)
+			{
+				// tags have no state, all entities can share the same instance
+				static TComponent tag{};
+				return tag;
+			}
+			if (const internal::DynamicVector *vector = GetVector(TypeId<TComponent>())) FLUFF_LIKELY
+			{
+				return vector->template Get<TComponent>(IndexOf(entity));
+			}
+			return static_cast<const Archetype *>(_group)->template Get<TComponent>(entity);
 		}
 
+		/// Gets the component of an entity without knowing its type
+		/// \param type id of the component type
+		/// \param entity the owning entity
+		/// \return a pointer to the component, or nullptr for tags
+		[[nodiscard]] const void *GetRaw(IdType type, EntityId entity) const FLUFF_NOEXCEPT
+		{
+			for (std::size_t i = 0; i < _typeInfos.size(); ++i)
+			{
+				if (_typeInfos[i].id == type)
+				{
+					return _componentVectors[i].GetBytes(_typeInfos[i].size * IndexOf(entity));
+				}
+			}
+			if (IsGroupedType(type))
+			{
+				return static_cast<const Archetype *>(_group)->GetRaw(type, entity);
+			}
+			return nullptr;
+		}
+		
+		/// Gets the component of an entity without knowing its type
+		/// \param type id of the component type
+		/// \param entity the owning entity
+		/// \return a pointer to the component, or nullptr for tags
+		[[nodiscard]] inline void *GetRaw(IdType type, EntityId entity) FLUFF_NOEXCEPT
+		{
+			return const_cast<void *>(static_cast<const Archetype *>(this)->GetRaw(type, entity));
+		}
+		
 		/// \param entity
 		/// \return the index in this container that the entity is assigned to
 		[[nodiscard]] inline IndexType IndexOf(EntityId entity) const FLUFF_MAYBE_NOEXCEPT
@@ -76,18 +155,24 @@ namespace flf
 			return _sparse[entity];
 		}
 
+		/// Starts loading the entry of IndexOf into the cache
+		/// \param entity contained in this container
+		inline void PrefetchIndexOf(EntityId entity) const FLUFF_NOEXCEPT
+		{
+			_sparse.Prefetch(entity);
+		}
+
 		/// Creates a single entity with the given components
 		/// \tparam TComponents of the entity
 		/// \return the id of the created entity
 		template<typename ...TComponents>
 		EntityId PushBack() FLUFF_MAYBE_NOEXCEPT
 		{
-			assert("Given Component types were not in container!" && sizeof...(TComponents) == _typeInfos.size());
+			assert("Given Component types were not in container!" && sizeof...(TComponents) == TypeCount());
 
-			((GetVector<TComponents>().template PushBack<TComponents>()), ...);
+			(EmplaceComponent<TComponents>(), ...);
 			auto index = world->TakeNextFreeIndex(*this);
-			_sparse.AddEntry(index, _componentIds.size());
-			_componentIds.push_back(index);
+			AddId(index);
 			return index;
 		}
 
@@ -97,12 +182,11 @@ namespace flf
 		template<typename ...TComponents>
 		EntityId PushBack(const TComponents &...comps) FLUFF_MAYBE_NOEXCEPT
 		{
-			assert("Given Component types were not in container!" && sizeof...(TComponents) == _typeInfos.size());
+			assert("Given Component types were not in container!" && sizeof...(TComponents) == TypeCount());
 
-			((GetVector<TComponents>().template PushBack<TComponents>(comps)), ...);
+			(EmplaceComponent<TComponents>(comps), ...);
 			auto index = world->TakeNextFreeIndex(*this);
-			_sparse.AddEntry(index, _componentIds.size());
-			_componentIds.push_back(index);
+			AddId(index);
 			return index;
 		}
 
@@ -112,30 +196,62 @@ namespace flf
 		template<typename ...TComponents>
 		EntityId EmplaceBack(TComponents &&...components) FLUFF_MAYBE_NOEXCEPT
 		{
-			assert(sizeof...(TComponents) == _typeInfos.size() && "Given Component types were not in container!");
+			assert(sizeof...(TComponents) == TypeCount() && "Given Component types were not in container!");
 
-			((GetVector<TComponents>().template EmplaceBack<TComponents>(std::forward<TComponents>(components))), ...);
+			(EmplaceComponent<TComponents>(std::forward<TComponents>(components)), ...);
 			auto index = world->TakeNextFreeIndex(*this);
-			_sparse.AddEntry(index, _componentIds.size());
-			_componentIds.push_back(index);
+			AddId(index);
 			return index;
 		}
 
+		/// Creates a single entity with those of the given components that belong to this container. The others are left
+		/// untouched, e.g. the sparse components that the world stores outside of the Archetypes
+		/// \param components of the entity, at least one for every type of this container
+		/// \return the id of the created entity
+		template<typename ...TComponents>
+		EntityId EmplaceBackContained(TComponents &&...components) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert((not std::is_reference_v<TComponents> && ...), "Components have to be passed as rvalues");
+			assert(((ContainsType(TypeId<TComponents>()) ? 1u : 0u) + ... + 0u) == TypeCount() && "Given Component types were not in container!");
+			
+			((ContainsType(TypeId<TComponents>()) ? EmplaceComponent<TComponents>(std::move(components)) : void()), ...);
+			auto index = world->TakeNextFreeIndex(*this);
+			AddId(index);
+			return index;
+		}
+		
 		/// Creates a multiple entities with the given components
 		/// \tparam TComponents of the entity
 		template<typename ...TComponents>
 		void CreateMultiple(const EntityId number) FLUFF_MAYBE_NOEXCEPT
 		{
-			assert(sizeof...(TComponents) == _typeInfos.size() && "Given Component types were not in container!");
+			assert(sizeof...(TComponents) == TypeCount() && "Given Component types were not in container!");
 
 			const auto beginSize = _componentIds.size();
 			const auto endSize = beginSize + number;
 
 			RegisterMultiple(beginSize, endSize);
-			// create component data
-			((GetVector<TComponents>().template Resize<TComponents>(beginSize + number)), ...);
+			// create component data. grouped vectors have a different size than this container
+			(GrowComponent<TComponents>(number), ...);
 		}
 
+		/// Creates multiple entities with default constructed components, without knowing the types at compile time
+		/// \param amount of entities to create
+		void CreateMultipleDefault(const IndexType amount) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto beginSize = _componentIds.size();
+			RegisterMultiple(beginSize, beginSize + amount);
+			
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				_componentVectors[i].GrowUsing(amount, _typeInfos[i].size, _constructors[i]);
+			}
+			for (IndexType i = 0; i < _groupedTypeInfos.size(); ++i)
+			{
+				_group->GetVector(_groupedTypeInfos[i].id)->GrowUsing(amount, _groupedTypeInfos[i].size, _groupedConstructors[i]);
+			}
+		}
+		
 		/// Creates a multiple entities with the given components
 		/// \tparam TComponents of the container
 		/// \param amount of clones to create
@@ -146,12 +262,9 @@ namespace flf
 			assert(ContainsId(id) && "EntityId not found in this container");
 			assert((ContainsType(TypeId<TComponents>()) && ...) && "Component types are not in this vector");
 
-			const auto beginSize = _componentIds.size();
-			const auto endSize = beginSize + amount;
-			const auto index = IndexOf(id);
-
-			RegisterMultiple(beginSize, endSize);
-			Clone<TComponents...>(amount, Get<TComponents>(index)...);
+			// the components are taken from the vectors that grow, which moves all columns of a shared allocation at once
+			ReserveAdditionalRows(amount);
+			Clone<TComponents...>(amount, Get<TComponents>(id)...);
 		}
 
 		/// Creates a multiple entities with the given components
@@ -167,13 +280,142 @@ namespace flf
 
 			RegisterMultiple(beginSize, endSize);
 
-			((GetVector<TComponents>().template ResizeUnsafe<TComponents>(endSize)), ...);
-			((GetVector<TComponents>().template Fill<TComponents>(beginSize, endSize, components)), ...);
+			// grouped vectors have a different size than this container
+			(FillNew<TComponents>(amount, components), ...);
+		}
+		
+		/// Creates multiple entities with copies of the values of a prefab. Every vector is filled with a single bulk copy
+		/// \param row containing a value for every non empty type of this container
+		/// \param amount of entities to create
+		void Instantiate(const internal::PrefabRow &row, const IndexType amount) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto beginSize = _componentIds.size();
+			RegisterMultiple(beginSize, beginSize + amount);
+			
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				const void *value = row.ValueOf(_typeInfos[i].id);
+				assert(value && "Prefab does not contain a value for every type");
+				_componentVectors[i].FillUsing(value, amount, _typeInfos[i].size, _constructors[i]);
+			}
+			for (IndexType i = 0; i < _groupedTypeInfos.size(); ++i)
+			{
+				const void *value = row.ValueOf(_groupedTypeInfos[i].id);
+				assert(value && "Prefab does not contain a value for every type");
+				_group->GetVector(_groupedTypeInfos[i].id)->FillUsing(value, amount, _groupedTypeInfos[i].size, _groupedConstructors[i]);
+			}
 		}
 
+		/// Appends entities that were created outside of the world, e.g. by an EntityStage. Every vector grows at most once
+		/// and the components of every type are moved in a single bulk move
+		/// \param ids of the entities, reserved with WorldInternal::ReserveIds
+		/// \param amount of entities
+		/// \param typeInfos types of the columns, the same types as in this container
+		/// \param constructors of the types
+		/// \param columns the components, amount per non empty type in the order of typeInfos. Are left empty
+		void AppendColumns(const EntityId *ids, const IndexType amount, const TypeInformation *typeInfos, const internal::ConstructorVTable *constructors,
+		                   internal::DynamicVector *columns) FLUFF_MAYBE_NOEXCEPT
+		{
+			ReserveAdditionalRows(amount);
+			_componentIds.reserve(_componentIds.size() + amount);
+			for (IndexType i = 0; i < amount; ++i)
+			{
+				world->RegisterReservedId(ids[i], *this);
+				AddId(ids[i]);
+			}
+			
+			for (IndexType i = 0; i < TypeCount(); ++i)
+			{
+				if (constructors[i].isEmpty)
+				{
+					continue;
+				}
+				
+				internal::DynamicVector *target = GetVector(typeInfos[i].id);
+				if (target == nullptr)
+				{
+					target = _group->GetVector(typeInfos[i].id);
+				}
+				target->AppendMovedUsing(columns[i], typeInfos[i].size, constructors[i]);
+			}
+		}
+		
+		/// Moves entities to the Archetype with the same types in another world. The components are moved column by
+		/// column, so every vector of the destination grows at most once
+		/// \param destination Archetype of another world, containing exactly the types of this container
+		/// \param ids of the entities to move. They need to be contained in this container, be unique and sorted ascending by IndexOf
+		/// \param amount of entities
+		/// \param firstNewId first of amount ids reserved with WorldInternal::ReserveIds in the world of the destination
+		void MoveRowsTo(Archetype &destination, const EntityId *ids, const IndexType amount, const EntityId firstNewId) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(destination.world != world && "Entities can only be moved to another world");
+			assert(destination.GetMultiTypeId() == GetMultiTypeId() && "Destination needs to have the same types");
+			if (amount == 0)
+			{
+				return;
+			}
+			
+			destination.ReserveAdditionalRows(amount);
+			std::size_t bytesMoved = 0;
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				bytesMoved += MoveColumnTo(destination, _typeInfos[i], _constructors[i], _componentVectors[i], *this, ids, amount);
+			}
+			for (IndexType i = 0; i < _groupedTypeInfos.size(); ++i)
+			{
+				bytesMoved += MoveColumnTo(destination, _groupedTypeInfos[i], _groupedConstructors[i], *_group->GetVector(_groupedTypeInfos[i].id),
+				                           *_group, ids, amount);
+			}
+			
+			destination.RegisterMoved(firstNewId, amount);
+			RemoveSorted(ids, ids + amount);
+			CountMove(destination, bytesMoved, amount);
+		}
+		
+		/// Moves all entities to the Archetype with the same types in another world. Without holes and groups every vector is
+		/// moved in a single bulk move, otherwise like MoveRowsTo
+		/// \param destination Archetype of another world, containing exactly the types of this container
+		/// \param firstNewId first of Size() ids reserved with WorldInternal::ReserveIds in the world of the destination
+		void MoveAllTo(Archetype &destination, const EntityId firstNewId) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_group != nullptr || destination._group != nullptr || not _holes.empty()) FLUFF_UNLIKELY
+			{
+				VectorOf<EntityId> ids{_componentIds, &_sparseMemory};
+				ids.erase(std::remove(ids.begin(), ids.end(), HOLE_ID), ids.end());
+				MoveRowsTo(destination, ids.data(), ids.size(), firstNewId);
+				return;
+			}
+			
+			assert(destination.world != world && "Entities can only be moved to another world");
+			assert(destination.GetMultiTypeId() == GetMultiTypeId() && "Destination needs to have the same types");
+			const IndexType amount = _componentIds.size();
+			if (amount == 0)
+			{
+				return;
+			}
+			
+			destination.ReserveAdditionalRows(amount);
+			std::size_t bytesMoved = 0;
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				bytesMoved += _componentVectors[i].ByteSize();
+				destination.GetVector(_typeInfos[i].id)->AppendMovedUsing(_componentVectors[i], _typeInfos[i].size, _constructors[i]);
+			}
+			destination.RegisterMoved(firstNewId, amount);
+			
+			// the vectors were left empty by the bulk move
+			for (const EntityId id : _componentIds)
+			{
+				_sparse.MarkAsDeleted(id);
+			}
+			_componentIds.clear();
+			TrimIfSparse();
+			CountMove(destination, bytesMoved, amount);
+		}
+		
 		/// Removes all components associated with the given id
 		/// \param id of the entity to remove
-		void Remove(EntityId id) FLUFF_NOEXCEPT
+		void Remove(EntityId id) FLUFF_MAYBE_NOEXCEPT
 		{
 			assert(ContainsId(id) && "Entity was not in Container");
 
@@ -183,34 +425,447 @@ namespace flf
 				return;
 			}
 
+			if (_group)
+			{
+				_group->Remove(id);
+			}
+			RemoveLocal(id);
+		}
 
-			if (const auto index = IndexOf(id); index != Size())
+		/// Removes all entities of this container at once. Destructors are only called for component types that are not
+		/// trivially destructible, the capacity of the vectors is kept unless the growth policy trims it
+		void Clear() FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_group)
+			{
+				RemoveFromGroup(_componentIds.data(), _componentIds.data() + _componentIds.size());
+			}
+			
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				auto &currVector = _componentVectors[i];
+				
+				if (not _constructors[i].isTriviallyDestructible)
+				{
+					const auto elementSize = _typeInfos[i].size;
+					std::byte *curr = static_cast<std::byte *>(currVector.Data());
+					for (IndexType row = 0; row < _componentIds.size(); ++row, curr += elementSize)
+					{
+						// holes were already destructed
+						if (_componentIds[row] != HOLE_ID)
+						{
+							_constructors[i].destruct(curr);
+						}
+					}
+				}
+				currVector.PopBackBytes(currVector.ByteSize());
+			}
+			
+			for (const EntityId id : _componentIds)
+			{
+				if (id != HOLE_ID)
+				{
+					_sparse.MarkAsDeleted(id);
+				}
+			}
+			_componentIds.clear();
+			_holes.clear();
+			TrimIfSparse();
+		}
+		
+		/// Removes multiple entities at once, compacting each vector only once. Keeps the relative order of the remaining entities.
+		/// When using RemovalPolicy::KeepOrder the compaction is delayed until the next call to Compact()
+		/// \param begin of the ids to remove. They need to be contained in this container, be unique and sorted ascending by IndexOf
+		/// \param end of the ids to remove
+		void RemoveSorted(const EntityId *begin, const EntityId *end) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto nRemoved = static_cast<IndexType>(end - begin);
+			if (nRemoved == 0)
+			{
+				return;
+			}
+			if (nRemoved == Size())
+			{
+				Clear();
+				return;
+			}
+			
+			if (_group)
+			{
+				RemoveFromGroup(begin, end);
+			}
+			for (const EntityId *curr = begin; curr < end; ++curr)
+			{
+				MarkAsHole(IndexOf(*curr));
+			}
+			
+			if (_removalPolicy == RemovalPolicy::SwapWithLast)
+			{
+				Compact();
+			}
+		}
+		
+		/// Closes all holes left by removals in RemovalPolicy::KeepOrder, moving each vector only once.
+		/// The relative order of the entities is kept
+		void Compact() FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_holes.empty())
+			{
+				return;
+			}
+			
+			const IndexType firstRow = _holes.front();
+			const IndexType nRows = _componentIds.size();
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				const auto elementSize = _typeInfos[i].size;
+				const auto constructors = _constructors[i];
+				auto &currVector = _componentVectors[i];
+				std::byte *const data = static_cast<std::byte *>(currVector.Data());
+				
+				std::byte *write = data + firstRow * elementSize;
+				for (IndexType row = firstRow; row < nRows; ++row)
+				{
+					if (_componentIds[row] != HOLE_ID)
+					{
+						RelocateElement(constructors, write, data + row * elementSize);
+						write += elementSize;
+					}
+				}
+				currVector.PopBackBytes(_holes.size() * elementSize);
+			}
+			
+			// the ids are compacted last, as they were needed to find the holes
+			IndexType write = firstRow;
+			for (IndexType row = firstRow; row < nRows; ++row)
+			{
+				if (const EntityId id = _componentIds[row]; id != HOLE_ID)
+				{
+					_componentIds[write] = id;
+					_sparse.SetEntry(id, write);
+					++write;
+				}
+			}
+			_componentIds.resize(write);
+			_holes.clear();
+			TrimIfSparse();
+		}
+		
+		/// Sorts all entities of this container by one of their components. The order is computed once and then applied
+		/// to every vector. Equal elements keep their relative order
+		/// \tparam TComponent to sort by. When it is stored in the group of this container, the group needs to be sorted instead
+		/// \param compare callable with signature bool(const TComponent &, const TComponent &), returning true when the first element shall be first
+		/// \param mode algorithm to use
+		/// \param scratch buffer to reorder the vectors in. Grown to the largest vector, keep it to reuse it for the next sort
+		template<typename TComponent, typename TCompare>
+		void Sort(TCompare &&compare, SortMode mode, std::pmr::vector<std::max_align_t> &scratch) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(not internal::IsEmpty<TComponent>, "Cannot sort by an empty type");
+			
+			const internal::DynamicVector *vector = GetVector(TypeId<TComponent>());
+			if (vector == nullptr)
+			{
+				return;
+			}
+			
+			Compact();
+			
+			const TComponent *const data = std::launder(reinterpret_cast<const TComponent *>(vector->Data()));
+			const auto compareRows = [&compare, data](IndexType lhs, IndexType rhs)
+			{
+				return compare(data[lhs], data[rhs]);
+			};
+			
+			VectorOf<IndexType> order(_componentIds.size(), &_sparseMemory);
+			std::iota(order.begin(), order.end(), IndexType(0));
+			if (mode == SortMode::Full)
+			{
+				std::stable_sort(order.begin(), order.end(), compareRows);
+			} else
+			{
+				for (IndexType i = 1; i < order.size(); ++i)
+				{
+					const IndexType row = order[i];
+					IndexType j = i;
+					for (; j > 0 && compareRows(row, order[j - 1]); --j)
+					{
+						order[j] = order[j - 1];
+					}
+					order[j] = row;
+				}
+			}
+			
+			ApplyOrder(order, scratch);
+		}
+		
+		/// Sets how single entities are removed from this container. Switching to RemovalPolicy::SwapWithLast closes all existing holes
+		/// \param policy to use from now on
+		void SetRemovalPolicy(RemovalPolicy policy) FLUFF_NOEXCEPT
+		{
+			_removalPolicy = policy;
+			if (policy == RemovalPolicy::SwapWithLast)
+			{
+				Compact();
+			}
+		}
+		
+		[[nodiscard]] inline RemovalPolicy GetRemovalPolicy() const FLUFF_NOEXCEPT
+		{
+			return _removalPolicy;
+		}
+		
+		/// \return the rows that contain no entity, sorted ascending. Only non empty when using RemovalPolicy::KeepOrder
+		[[nodiscard]] inline const VectorOf<IndexType> &GetHoles() const FLUFF_NOEXCEPT
+		{
+			return _holes;
+		}
+		
+		/// Sets the growth policy, memory accounting and change counters of all current and future vectors of this container
+		/// \param context of the owning world. May be nullptr
+		void SetVectorContext(internal::VectorContext *context) FLUFF_NOEXCEPT
+		{
+			_vectorContext = context;
+			for (auto &vector : _componentVectors)
+			{
+				vector.SetContext(context);
+			}
+			for (auto &vector : _frontVectors)
+			{
+				vector.SetContext(context);
+			}
+			_arena.SetContext(context);
+			_sparse.SetResizeCounter(context != nullptr ? &context->changes.sparseResizes : nullptr);
+		}
+		
+		/// Calls function for every Archetype entities were moved to from this one since the last ResetTransitionCounts
+		/// \param function with signature void(const TransitionStats &)
+		template<typename TFunc>
+		void ForeachTransition(TFunc &&function) const
+		{
+			for (const OutgoingMoves &moves : _outgoingMoves)
+			{
+				if (moves.entitiesMoved != 0)
+				{
+					function(TransitionStats{GetMultiTypeId(), moves.destination, moves.entitiesMoved, moves.bytesMoved});
+				}
+			}
+		}
+		
+		/// Sets the counts of all transitions from this Archetype to zero. Keeps their memory, so that counting the same
+		/// transitions again does not allocate
+		void ResetTransitionCounts() FLUFF_NOEXCEPT
+		{
+			for (OutgoingMoves &moves : _outgoingMoves)
+			{
+				moves.entitiesMoved = 0;
+				moves.bytesMoved = 0;
+			}
+		}
+		
+		/// Sets whether all vectors of this container are saved in a single allocation with a shared capacity. They are
+		/// grown together then, with one allocation per growth step instead of one per vector
+		/// \param enabled true to use a single allocation, false to let every vector allocate on its own
+		void SetSharedAllocation(bool enabled) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (enabled == _arena.IsEnabled())
+			{
+				return;
+			}
+			
+			if (enabled)
+			{
+				_arena.Enable(*_ownResource, _vectorContext);
+			} else
+			{
+				_arena.Disable();
+			}
+		}
+		
+		/// \return true when all vectors of this container are saved in a single allocation
+		[[nodiscard]] inline bool HasSharedAllocation() const FLUFF_NOEXCEPT
+		{
+			return _arena.IsEnabled();
+		}
+		
+		/// Closes all holes and reduces the capacity of all vectors to the number of entities
+		void ShrinkToFit() FLUFF_MAYBE_NOEXCEPT
+		{
+			Compact();
+			ShrinkVectorsTo(_componentIds.size());
+			_componentIds.shrink_to_fit();
+			_holes.shrink_to_fit();
+		}
+		
+		/*
+		 * Group methods
+		 */
+		
+		/// Moves the vectors of all types contained in group into it. From now on, the components of these types are
+		/// saved in the group for all entities of this container
+		/// \param group Archetype that contains the components of all entities having at least its types
+		void AttachGroup(Archetype &group) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(_group == nullptr && "Archetype is already part of a group");
+			
+			_group = &group;
+			for (IndexType i = 0; i < _typeInfos.size();)
+			{
+				internal::DynamicVector *groupVector = group.GetVector(_typeInfos[i].id);
+				if (groupVector == nullptr)
+				{
+					++i;
+					continue;
+				}
+				
+				// move over already existing components
+				const auto tInfo = _typeInfos[i];
+				const auto constructors = _constructors[i];
+				auto &currVector = _componentVectors[i];
+				for (IndexType row = 0; row < _componentIds.size(); ++row)
+				{
+					if (_componentIds[row] != HOLE_ID)
+					{
+						void *data = currVector.GetBytes(row * tInfo.size);
+						MoveInto(*groupVector, data, tInfo.size, constructors);
+						constructors.destruct(data);
+					}
+				}
+				currVector.Release();
+				
+				_groupedTypeInfos.push_back(tInfo);
+				_groupedConstructors.push_back(constructors);
+				_typeInfos.erase(_typeInfos.cbegin() + i);
+				_constructors.erase(_constructors.cbegin() + i);
+				_componentVectors.erase(_componentVectors.cbegin() + i);
+			}
+			
+			for (const EntityId id : _componentIds)
+			{
+				if (id != HOLE_ID)
+				{
+					group.AddId(id);
+				}
+			}
+		}
+		
+		/// \return the group containing some of the components of this container, or nullptr if it is not part of a group
+		[[nodiscard]] inline Archetype *GetGroup() const FLUFF_NOEXCEPT
+		{
+			return _group;
+		}
+		
+		/// \param type to check for
+		/// \return true if the components of that type are saved in the group of this container
+		[[nodiscard]] inline bool IsGroupedType(IdType type) const FLUFF_NOEXCEPT
+		{
+			for (const auto tInfo : _groupedTypeInfos)
+			{
+				if (tInfo.id == type)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		
+		/*
+		 * Double buffer methods
+		 */
+		
+		/// Exchanges the vector of a type with its front buffer, so that the front buffer contains the current values.
+		/// The current values are then copied back into the vector, which keeps them, so systems can keep updating the
+		/// components in place. The front buffer is created by the first swap
+		/// \param type id of a trivially copyable type with a vector in this container
+		/// \param resource to allocate the front buffer from
+		void SwapFrontBuffer(IdType type, std::pmr::memory_resource &resource) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(not _arena.IsEnabled() && "Types of containers with a shared allocation cannot be double buffered");
+			
+			IndexType column = 0;
+			while (column < _typeInfos.size() && _typeInfos[column].id != type)
+			{
+				++column;
+			}
+			assert(column < _typeInfos.size() && "Type has no vector in this container");
+			assert(_constructors[column].isTriviallyCopyable && "Only trivially copyable types can be double buffered");
+			
+			auto found = std::find(_frontTypes.cbegin(), _frontTypes.cend(), type);
+			if (found == _frontTypes.cend()) FLUFF_UNLIKELY
+			{
+				_frontTypes.push_back(type);
+				_frontVectors.emplace_back(resource).SetContext(_vectorContext);
+				found = _frontTypes.cend() - 1;
+			}
+			
+			internal::DynamicVector &front = _frontVectors[found - _frontTypes.cbegin()];
+			internal::DynamicVector &back = _componentVectors[column];
+			std::swap(front, back);
+			
+			// the new back vector holds the values of the previous swap, it is resized to the rows and overwritten with
+			// the current values
+			const std::size_t elementSize = _typeInfos[column].size;
+			const IndexType backRows = back.ByteSize() / elementSize;
+			if (backRows < _componentIds.size())
+			{
+				back.GrowUsing(_componentIds.size() - backRows, elementSize, _constructors[column]);
+			} else
+			{
+				back.PopBackBytes((backRows - _componentIds.size()) * elementSize);
+			}
+			if (not _componentIds.empty())
+			{
+				std::memcpy(back.Data(), front.Data(), _componentIds.size() * elementSize);
+			}
+		}
+		
+		/// \param type id of a double buffered type
+		/// \return the front buffer of the type, or nullptr if it was never swapped
+		[[nodiscard]] const internal::DynamicVector *GetFrontBuffer(IdType type) const FLUFF_NOEXCEPT
+		{
+			for (std::size_t i = 0; i < _frontTypes.size(); ++i)
+			{
+				if (_frontTypes[i] == type)
+				{
+					return &_frontVectors[i];
+				}
+			}
+			return nullptr;
+		}
+	
+	private:
+		/// Removes all components associated with the given id that are saved directly in this container
+		/// \param id of the entity to remove
+		void RemoveLocal(EntityId id) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto index = IndexOf(id);
+			if (_removalPolicy == RemovalPolicy::KeepOrder && index + 1 != _componentIds.size())
+			{
+				// leave a hole that will be closed by the next Compact()
+				MarkAsHole(index);
+				return;
+			}
+
+			if (index + 1 != _componentIds.size())
 			{
 				const EntityId movedEntity = _componentIds.back();
 				_componentIds[index] = movedEntity;
 				_sparse.SetEntry(movedEntity, index);
+			}
 
-				// move components from back to index as we don't need the data at index anymore
-				for (IndexType i = 0; i < _typeInfos.size(); ++i)
-				{
-					const auto tInfo = _typeInfos[i];
-					auto &currVector = _componentVectors[i];
+			// move components from back to index as we don't need the data at index anymore
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				const auto tInfo = _typeInfos[i];
+				auto &currVector = _componentVectors[i];
 
-					const auto bytePosition = tInfo.size * index;
-					void *dataToMove = currVector.GetBytes(bytePosition);
-					void *end = currVector.BackPtr() - tInfo.size;
+				const auto bytePosition = tInfo.size * index;
+				void *dataToMove = currVector.GetBytes(bytePosition);
+				void *end = currVector.BackPtr() - tInfo.size;
 
-					if (dataToMove != end) FLUFF_LIKELY
-					{
-						if (_constructors[i].moveConstruct)
-						{
-							_constructors[i].moveConstruct(dataToMove, end);
-						} else
-						{
-							_constructors[i].copyConstruct(dataToMove, end);
-						}
-					}
-					_constructors[i].destruct(dataToMove);
+				_constructors[i].destruct(dataToMove);
+				if (dataToMove != end) FLUFF_LIKELY
+				{
+					RelocateElement(_constructors[i], dataToMove, end);
 				}
 			}
 
@@ -223,18 +878,20 @@ namespace flf
 			{
 				_componentVectors[i].PopBackBytes(_typeInfos[i].size);
 			}
+			TrimIfSparse();
 		}
 
+	public:
 		/// Reserves the given amount of components
 		/// \tparam TComponents to reserve
 		/// \param n amount of entries to reserve
 		template<typename ...TComponents>
 		void Reserve(IndexType n)
 		{
-			((GetVector<TComponents>().template Reserve<TComponents>(n)), ...);
+			(ReserveComponent<TComponents>(n), ...);
 		}
 
-		/// \return the list of saved entity ids. the list is in the same order as the component data
+		/// \return the list of saved entity ids. the list is in the same order as the component data. Holes are marked with HOLE_ID
 		[[nodiscard]] inline const VectorOf<EntityId> &GetIds() const FLUFF_NOEXCEPT
 		{
 			return _componentIds;
@@ -242,6 +899,12 @@ namespace flf
 
 		/// \return the number of entities contained
 		[[nodiscard]] inline IndexType Size() const FLUFF_NOEXCEPT
+		{
+			return _componentIds.size() - _holes.size();
+		}
+
+		/// \return the number of rows in the vectors, including holes
+		[[nodiscard]] inline IndexType RowCount() const FLUFF_NOEXCEPT
 		{
 			return _componentIds.size();
 		}
@@ -258,6 +921,40 @@ namespace flf
 			}
 		}
 
+		/// \return the number of types that have a vector in this container, without grouped types and tags
+		[[nodiscard]] inline IndexType ColumnCount() const FLUFF_NOEXCEPT
+		{
+			return _typeInfos.size();
+		}
+		
+		/// \param column index of the column, smaller than ColumnCount()
+		/// \return the memory of the column
+		[[nodiscard]] ColumnMemoryStats GetColumnMemory(IndexType column) const FLUFF_NOEXCEPT
+		{
+			assert(column < ColumnCount() && "Column out of range");
+			return {_typeInfos[column].id, Size() * _typeInfos[column].size, _componentVectors[column].ByteCapacity()};
+		}
+		
+		/// Sums up the memory of all columns. Does not allocate, so it can be sampled every frame
+		/// \return the memory used by this container
+		[[nodiscard]] ArchetypeMemoryStats GetMemoryStats() const FLUFF_NOEXCEPT
+		{
+			ArchetypeMemoryStats stats{};
+			stats.signature = GetMultiTypeId();
+			stats.entityCount = Size();
+			stats.rowCount = RowCount();
+			stats.capacity = Capacity();
+			stats.columnCount = ColumnCount();
+			for (IndexType i = 0; i < ColumnCount(); ++i)
+			{
+				const ColumnMemoryStats column = GetColumnMemory(i);
+				stats.usedBytes += column.usedBytes;
+				stats.reservedBytes += column.reservedBytes;
+			}
+			stats.idBytes = _componentIds.capacity() * sizeof(EntityId) + _holes.capacity() * sizeof(IndexType) + _sparse.ByteCapacity();
+			return stats;
+		}
+	
 	public:
 		/// \return the MultiIdType of the sum of all contained components
 		[[nodiscard]] inline MultiIdType GetMultiTypeId() const FLUFF_NOEXCEPT
@@ -267,6 +964,14 @@ namespace flf
 			{
 				result = result xor tInfo.id;
 			}
+			for (auto tInfo : _groupedTypeInfos)
+			{
+				result = result xor tInfo.id;
+			}
+			for (auto tInfo : _tagTypeInfos)
+			{
+				result = result xor tInfo.id;
+			}
 			return result;
 		}
 
@@ -275,6 +980,51 @@ namespace flf
 		 * Dynamic Vector Methods
 		 */
 
+		/// Adds the given component type to this container. Empty types are only saved in the signature, all others get a vector
+		/// \tparam TComponent to be containable
+		/// \param resource to use for the vector
+		template<typename TComponent>
+		inline void AddType(std::pmr::memory_resource &resource) FLUFF_MAYBE_NOEXCEPT
+		{
+			if constexpr (internal::IsEmpty<TComponent>)
+			{
+				AddTag(TypeInformation::Of<TComponent>(), internal::ConstructorVTable::Of<TComponent>());
+			} else
+			{
+				AddVector<TComponent>(resource);
+			}
+		}
+		
+		/// Adds the given type to this container. Empty types are only saved in the signature, all others get a vector
+		/// \param type to contain
+		/// \param constructors of the type
+		/// \param resource to use for the vector
+		void AddType(TypeInformation type, internal::ConstructorVTable constructors, std::pmr::memory_resource &resource) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (constructors.isEmpty)
+			{
+				AddTag(type, constructors);
+			} else
+			{
+				AddVector(type, constructors, resource);
+			}
+		}
+		
+		/// Adds an empty type that is only saved in the signature of this container
+		/// \param type to contain
+		/// \param constructors of the type
+		void AddTag(TypeInformation type, internal::ConstructorVTable constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(!ContainsType(type.id) && "Type already in container!");
+			assert(constructors.isEmpty && "Only empty types can be tags");
+			
+			// keep the tags sorted by id
+			const auto position = std::upper_bound(_tagTypeInfos.cbegin(), _tagTypeInfos.cend(), type.id,
+			                                       [](IdType id, const TypeInformation &tInfo) { return id < tInfo.id; });
+			_tagConstructors.insert(_tagConstructors.cbegin() + (position - _tagTypeInfos.cbegin()), constructors);
+			_tagTypeInfos.insert(position, type);
+		}
+		
 		/// Adds a vector for the given component type
 		/// \tparam TComponent to be containable
 		/// \param resource to use for that vector
@@ -301,27 +1051,98 @@ namespace flf
 			_typeInfos.push_back(type);
 			_constructors.emplace_back(constructors);
 
-			return _componentVectors.emplace_back(resource);
+			internal::DynamicVector &createdVector = _componentVectors.emplace_back(resource);
+			createdVector.SetContext(_vectorContext);
+			if (_arena.IsEnabled())
+			{
+				// moves the new vector into the shared allocation
+				_arena.Grow(_arena.Capacity());
+			}
+			return createdVector;
 		}
 
 		/// \tparam TComponent type to contain in the vector
-		/// \return a reference to a vector containing that type
+		/// \return a reference to a vector containing that type. Might be a vector of the group of this container
 		template<typename TComponent>
 		[[nodiscard]] inline const internal::DynamicVector &GetVector() const FLUFF_NOEXCEPT
 		{
 			assert(ContainsType(TypeId<TComponent>()) && "Type not in Archetype");
-			return *GetVector(TypeId<TComponent>());
+			if (const internal::DynamicVector *vector = GetVector(TypeId<TComponent>())) FLUFF_LIKELY
+			{
+				return *vector;
+			}
+			return *static_cast<const Archetype *>(_group)->GetVector(TypeId<TComponent>());
 		}
 
 		/// \tparam TComponent type to contain in the vector
-		/// \return a reference to a vector containing that type
+		/// \return a reference to a vector containing that type. Might be a vector of the group of this container
 		template<typename TComponent>
 		[[nodiscard]] inline internal::DynamicVector &GetVector() FLUFF_NOEXCEPT
 		{
 			assert(ContainsType(TypeId<TComponent>()) && "Type not in Archetype");
-			return *GetVector(TypeId<TComponent>());
+			if (internal::DynamicVector *vector = GetVector(TypeId<TComponent>())) FLUFF_LIKELY
+			{
+				return *vector;
+			}
+			return *_group->GetVector(TypeId<TComponent>());
 		}
 
+		/// Constructs a component at the end of its vector. Does nothing for tags, as they are only saved in the signature
+		/// \tparam TComponent type of the component
+		/// \param args to construct the component from
+		template<typename TComponent, typename ...TArgs>
+		inline void EmplaceComponent(TArgs &&...args) FLUFF_MAYBE_NOEXCEPT
+		{
+			if constexpr (not internal::IsEmpty<TComponent>)
+			{
+				GetVector<TComponent>().template EmplaceBack<TComponent>(std::forward<TArgs>(args)...);
+			}
+		}
+		
+		/// Default constructs a component at the end of its vector, without knowing its type. Does nothing for tags
+		/// \param type id of the component type
+		void EmplaceDefault(IdType type) FLUFF_MAYBE_NOEXCEPT
+		{
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				if (_typeInfos[i].id == type)
+				{
+					_componentVectors[i].PushBackUsing(_typeInfos[i].size, _constructors[i]);
+					return;
+				}
+			}
+			for (IndexType i = 0; i < _groupedTypeInfos.size(); ++i)
+			{
+				if (_groupedTypeInfos[i].id == type)
+				{
+					_group->GetVector(type)->PushBackUsing(_groupedTypeInfos[i].size, _groupedConstructors[i]);
+					return;
+				}
+			}
+		}
+		
+		/// \param type id of a component type
+		/// \return a pointer to the first component of that type, or nullptr if it has no vector in this container
+		[[nodiscard]] void *ColumnData(IdType type) FLUFF_NOEXCEPT
+		{
+			internal::DynamicVector *vector = GetVector(type);
+			return vector ? vector->Data() : nullptr;
+		}
+		
+		/// \param type id of a component type
+		/// \return the size of a single component of that type, or 0 if it has no vector in this container
+		[[nodiscard]] std::size_t ColumnElementSize(IdType type) const FLUFF_NOEXCEPT
+		{
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				if (_typeInfos[i].id == type)
+				{
+					return _typeInfos[i].size;
+				}
+			}
+			return 0;
+		}
+		
 		/// Moves all data associated with the given entity to another Archetype
 		/// \param destination to move the data to
 		/// \param id associated with the data to be moved
@@ -330,44 +1151,55 @@ namespace flf
 			assert(ContainsId(id) && "Id not contained!");
 
 			const auto index = IndexOf(id);
+			// when both are part of the same group, the grouped components can stay where they are
+			const bool staysInGroup = _group != nullptr && _group == destination._group;
+			Archetype *const destinationGroup = staysInGroup ? nullptr : destination._group;
+			std::size_t bytesMoved = 0;
 
 			for (std::size_t i = 0; i < _typeInfos.size(); ++i)
 			{
 				const TypeInformation tInfo = _typeInfos[i];
-				const internal::ConstructorVTable constructors = _constructors[i];
 
 				internal::DynamicVector *targetVector = destination.GetVector(tInfo.id);
-				internal::DynamicVector *ownByteData = GetVector(tInfo.id);
-				const auto bytePosition = tInfo.size * index;
-
+				if (targetVector == nullptr && destinationGroup != nullptr)
+				{
+					targetVector = destinationGroup->GetVector(tInfo.id);
+				}
 
 				if (targetVector)
 				{
-					// copy data to target
-					if (ownByteData)
-					{
-						void *dataToMove = ownByteData->GetBytes(bytePosition);
+					MoveInto(*targetVector, _componentVectors[i].GetBytes(tInfo.size * index), tInfo.size, _constructors[i]);
+					bytesMoved += tInfo.size;
+				}
+			}
 
-						if (constructors.moveConstruct)
-						{
-							targetVector->EmplaceBackUsing(dataToMove, tInfo.size, constructors);
-						} else
-						{
-							targetVector->PushBackUsing(dataToMove, tInfo.size, constructors);
-						}
-					} else
+			if (_group != nullptr && not staysInGroup)
+			{
+				// the entity leaves the group, move the remaining grouped components back into the destination
+				const auto groupIndex = _group->IndexOf(id);
+				for (std::size_t i = 0; i < _groupedTypeInfos.size(); ++i)
+				{
+					const TypeInformation tInfo = _groupedTypeInfos[i];
+					if (internal::DynamicVector *targetVector = destination.GetVector(tInfo.id))
 					{
-						targetVector->PushBackUsing(tInfo.size, constructors);
+						MoveInto(*targetVector, _group->GetVector(tInfo.id)->GetBytes(tInfo.size * groupIndex), tInfo.size, _groupedConstructors[i]);
+						bytesMoved += tInfo.size;
 					}
 				}
+				_group->Remove(id);
 			}
 
 			// Register new entity
 			world->AssociateIdWith(id, destination);
 			destination._sparse.AddEntry(id, destination._componentIds.size());
 			destination._componentIds.push_back(id);
+			if (destinationGroup != nullptr)
+			{
+				destinationGroup->AddId(id);
+			}
 
-			Remove(id);
+			RemoveLocal(id);
+			CountMove(destination, bytesMoved);
 		}
 
 		/// Reserves a given amount of different component types
@@ -405,13 +1237,69 @@ namespace flf
 					return true;
 				}
 			}
+			return IsTagType(type) || IsGroupedType(type);
+		}
+
+		/// \return the number of component types of this container, including the ones saved in its group
+		[[nodiscard]] inline std::size_t TypeCount() const FLUFF_NOEXCEPT
+		{
+			return _typeInfos.size() + _groupedTypeInfos.size() + _tagTypeInfos.size();
+		}
+		
+		/// \param type to check for
+		/// \return true if the type is an empty type that is only saved in the signature of this container
+		[[nodiscard]] inline bool IsTagType(IdType type) const FLUFF_NOEXCEPT
+		{
+			for (const auto tInfo : _tagTypeInfos)
+			{
+				if (tInfo.id == type)
+				{
+					return true;
+				}
+			}
 			return false;
 		}
 
-		/// \return A vector with TypeInformation to all types in this container
+		/// \return A vector with TypeInformation to all types in this container, sorted by their id
 		[[nodiscard]] inline std::vector<TypeInformation> GetContainedTypes() const FLUFF_MAYBE_NOEXCEPT
 		{
-			return std::vector<TypeInformation>(_typeInfos.cbegin(), _typeInfos.cend());
+			std::vector<TypeInformation> types{};
+			std::vector<internal::ConstructorVTable> constructors{};
+			GetSignature(types, constructors);
+			return types;
+		}
+
+		/// Collects the TypeInformation and ConstructorVTable of all types in this container, including tags and the ones saved in its group
+		/// \param types will contain the TypeInformation of all types, sorted by their id
+		/// \param constructors will contain the ConstructorVTable in the same order as types
+		template<typename TAllocator1, typename TAllocator2>
+		void GetSignature(std::vector<TypeInformation, TAllocator1> &types, std::vector<internal::ConstructorVTable, TAllocator2> &constructors) const
+		{
+			types.clear();
+			constructors.clear();
+			types.reserve(TypeCount());
+			constructors.reserve(TypeCount());
+			
+			// all lists are sorted already, we only need to merge them
+			const VectorOf<TypeInformation> *typeLists[] = {&_typeInfos, &_groupedTypeInfos, &_tagTypeInfos};
+			const VectorOf<internal::ConstructorVTable> *constructorLists[] = {&_constructors, &_groupedConstructors, &_tagConstructors};
+			std::size_t positions[] = {0, 0, 0};
+			while (types.size() < TypeCount())
+			{
+				std::size_t next = std::size(typeLists);
+				for (std::size_t list = 0; list < std::size(typeLists); ++list)
+				{
+					if (positions[list] < typeLists[list]->size() &&
+					    (next == std::size(typeLists) || (*typeLists[list])[positions[list]].id < (*typeLists[next])[positions[next]].id))
+					{
+						next = list;
+					}
+				}
+				
+				types.push_back((*typeLists[next])[positions[next]]);
+				constructors.push_back((*constructorLists[next])[positions[next]]);
+				++positions[next];
+			}
 		}
 
 
@@ -432,19 +1320,313 @@ namespace flf
 			_typeInfos = VectorOf<TypeInformation>(_ownResource);
 			_constructors = VectorOf<internal::ConstructorVTable>(_ownResource);
 			_componentVectors = VectorOf<internal::DynamicVector>(_ownResource);
+			_groupedTypeInfos = VectorOf<TypeInformation>(_ownResource);
+			_groupedConstructors = VectorOf<internal::ConstructorVTable>(_ownResource);
+			_tagTypeInfos = VectorOf<TypeInformation>(_ownResource);
+			_tagConstructors = VectorOf<internal::ConstructorVTable>(_ownResource);
 		}
 
+		/// \return the TypeInformation of all types that have a vector in this container. Does not contain the grouped types
 		[[nodiscard]] const VectorOf<TypeInformation> &GetTypeInfos() const FLUFF_NOEXCEPT
 		{
 			return _typeInfos;
 		}
 
+		/// \return the ConstructorVTable of all types that have a vector in this container. Does not contain the grouped types
 		[[nodiscard]] const VectorOf<internal::ConstructorVTable> &GetConstructorTable() const FLUFF_NOEXCEPT
 		{
 			return _constructors;
 		}
 
 	private:
+		/// Moves an element to uninitialized memory and destructs the source
+		/// \param constructors of the elements type
+		/// \param at uninitialized memory to move to
+		/// \param from element to move. Will be destructed afterwards
+		static void RelocateElement(const internal::ConstructorVTable &constructors, void *at, void *from) FLUFF_NOEXCEPT
+		{
+			if (at == from)
+			{
+				return;
+			}
+			
+			if (constructors.moveConstruct)
+			{
+				constructors.moveConstruct(at, from);
+			} else
+			{
+				constructors.copyConstruct(at, from);
+			}
+			constructors.destruct(from);
+		}
+		
+		/// Constructs a copy of an element at the end of a vector, moving from the element if possible
+		/// \param target vector to add the element to
+		/// \param data element to move from
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors of the elements type
+		static void MoveInto(internal::DynamicVector &target, void *data, std::size_t elementSize, const internal::ConstructorVTable &constructors)
+		FLUFF_MAYBE_NOEXCEPT
+		{
+			if (constructors.moveConstruct)
+			{
+				target.EmplaceBackUsing(data, elementSize, constructors);
+			} else
+			{
+				target.PushBackUsing(data, elementSize, constructors);
+			}
+		}
+		
+		/// Copies a component to the end of its vector multiple times. Does nothing for tags
+		/// \param amount of copies
+		/// \param component to copy
+		template<typename TComponent>
+		void FillNew(IndexType amount, const TComponent &component) FLUFF_MAYBE_NOEXCEPT
+		{
+			if constexpr (not internal::IsEmpty<TComponent>)
+			{
+				GetVector<TComponent>().FillUsing(&component, amount, sizeof(TComponent), internal::ConstructorVTable::Of<TComponent>());
+			}
+		}
+		
+		/// Adds default constructed components to the end of their vector. Does nothing for tags
+		/// \param amount of components to add
+		template<typename TComponent>
+		void GrowComponent(IndexType amount) FLUFF_MAYBE_NOEXCEPT
+		{
+			if constexpr (not internal::IsEmpty<TComponent>)
+			{
+				internal::DynamicVector &vector = GetVector<TComponent>();
+				vector.Resize<TComponent>(vector.Size<TComponent>() + amount);
+			}
+		}
+		
+		/// Reserves memory for the components of a type. Does nothing for tags
+		/// \param n amount of entries to reserve
+		template<typename TComponent>
+		void ReserveComponent(IndexType n) FLUFF_MAYBE_NOEXCEPT
+		{
+			if constexpr (not internal::IsEmpty<TComponent>)
+			{
+				GetVector<TComponent>().template Reserve<TComponent>(n);
+			}
+		}
+		
+		/// Reduces the capacity of all vectors, keeping room for the given number of rows
+		/// \param rows that shall still fit into the vectors. Has to be at least RowCount()
+		void ShrinkVectorsTo(IndexType rows) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_arena.IsEnabled())
+			{
+				_arena.ShrinkTo(rows);
+				return;
+			}
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				_componentVectors[i].ShrinkToFitUsing(_typeInfos[i].size, _constructors[i], rows);
+			}
+		}
+		
+		/// Counts an entity that was moved from this container to another one, of this or of another world
+		/// \param destination the entity was moved to
+		/// \param bytesMoved size of the moved components
+		/// \param nEntities number of moved entities
+		void CountMove(const Archetype &destination, std::size_t bytesMoved, std::size_t nEntities = 1) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_vectorContext == nullptr)
+			{
+				return;
+			}
+			
+			_vectorContext->changes.entitiesMoved += nEntities;
+			_vectorContext->changes.bytesMoved += bytesMoved;
+			
+			// an Archetype usually has only a few transitions, so a linear search is faster than a map
+			const MultiIdType signature = destination.GetMultiTypeId();
+			auto moves = std::find_if(_outgoingMoves.begin(), _outgoingMoves.end(),
+			                          [signature](const OutgoingMoves &other) { return other.destination == signature; });
+			if (moves == _outgoingMoves.end()) FLUFF_UNLIKELY
+			{
+				moves = _outgoingMoves.insert(_outgoingMoves.end(), OutgoingMoves{signature});
+			}
+			moves->entitiesMoved += nEntities;
+			moves->bytesMoved += bytesMoved;
+		}
+		
+		/// Moves the components of some entities from a vector of this container or its group to the end of the vector of
+		/// the same type in an Archetype of another world, growing it at most once
+		/// \param destination Archetype with the same types
+		/// \param tInfo type of the vector
+		/// \param constructors of the type
+		/// \param source vector to move from
+		/// \param rowsOf this container or its group, whichever source belongs to
+		/// \param ids of the entities to move
+		/// \param amount of entities
+		/// \return the number of moved bytes
+		static std::size_t MoveColumnTo(Archetype &destination, TypeInformation tInfo, const internal::ConstructorVTable &constructors,
+		                                internal::DynamicVector &source, const Archetype &rowsOf, const EntityId *ids, IndexType amount)
+		FLUFF_MAYBE_NOEXCEPT
+		{
+			internal::DynamicVector *target = destination.GetVector(tInfo.id);
+			if (target == nullptr)
+			{
+				target = destination._group->GetVector(tInfo.id);
+			}
+			
+			const std::size_t requiredBytes = target->ByteSize() + amount * tInfo.size;
+			if (requiredBytes > target->ByteCapacity())
+			{
+				target->ReserveUsing(tInfo.size, constructors, requiredBytes / tInfo.size);
+			}
+			for (IndexType i = 0; i < amount; ++i)
+			{
+				MoveInto(*target, source.GetBytes(rowsOf.IndexOf(ids[i]) * tInfo.size), tInfo.size, constructors);
+			}
+			return amount * tInfo.size;
+		}
+		
+		/// Registers entities whose components were moved to the end of the vectors from another world
+		/// \param firstId first of the ids reserved for them in the world of this container
+		/// \param amount of entities
+		void RegisterMoved(EntityId firstId, IndexType amount) FLUFF_MAYBE_NOEXCEPT
+		{
+			_componentIds.reserve(_componentIds.size() + amount);
+			for (EntityId id = firstId; id < firstId + amount; ++id)
+			{
+				world->RegisterReservedId(id, *this);
+				AddId(id);
+			}
+		}
+		
+		/// Gives memory back when the growth policy of the world has a shrink threshold and the vectors are used less
+		/// than that. The vectors keep room for one growth step, so that adding entities afterwards does not reallocate at once
+		void TrimIfSparse() FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_vectorContext == nullptr || _vectorContext->growthPolicy.shrinkThreshold <= 0.0 || not _holes.empty()) FLUFF_LIKELY
+			{
+				return;
+			}
+			
+			const IndexType capacity = Capacity();
+			const IndexType rows = _componentIds.size();
+			if (capacity <= VECTOR_PRE_RESERVE_AMOUNT || static_cast<double>(rows) >= static_cast<double>(capacity) * _vectorContext->growthPolicy.shrinkThreshold)
+			{
+				return;
+			}
+			
+			const IndexType targetRows = std::max<IndexType>(_vectorContext->growthPolicy.NextCapacity(rows, rows), VECTOR_PRE_RESERVE_AMOUNT);
+			if (targetRows < capacity)
+			{
+				ShrinkVectorsTo(targetRows);
+			}
+		}
+		
+		/// Makes sure that a number of new rows fit into the vectors of this container and its group without a
+		/// reallocation. Only has an effect for shared allocations, whose growth moves all vectors at once
+		/// \param amount of rows to add
+		void ReserveAdditionalRows(IndexType amount) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_arena.IsEnabled())
+			{
+				_arena.Reserve(_componentIds.size() + amount);
+			}
+			if (_group)
+			{
+				_group->ReserveAdditionalRows(amount);
+			}
+		}
+		
+		/// Registers an entity at the end of this container and its group
+		/// \param id of the entity
+		void AddId(EntityId id) FLUFF_MAYBE_NOEXCEPT
+		{
+			_sparse.AddEntry(id, _componentIds.size());
+			_componentIds.push_back(id);
+			if (_group)
+			{
+				_group->AddId(id);
+			}
+		}
+		
+		/// Removes the grouped components of the given entities from the group
+		/// \param begin of the ids to remove. Holes are ignored
+		/// \param end of the ids to remove
+		void RemoveFromGroup(const EntityId *begin, const EntityId *end) FLUFF_MAYBE_NOEXCEPT
+		{
+			VectorOf<EntityId> ids{&_sparseMemory};
+			ids.reserve(end - begin);
+			std::copy_if(begin, end, std::back_inserter(ids), [](EntityId id) { return id != HOLE_ID; });
+			
+			const Archetype &group = *_group;
+			std::sort(ids.begin(), ids.end(), [&group](EntityId lhs, EntityId rhs) { return group.IndexOf(lhs) < group.IndexOf(rhs); });
+			_group->RemoveSorted(ids.data(), ids.data() + ids.size());
+		}
+		
+		/// Reorders all vectors and ids, so that the entity previously at order[i] is at row i afterwards
+		/// \param order permutation of all rows
+		/// \param scratch buffer to reorder the vectors in, grown to the largest vector
+		void ApplyOrder(const VectorOf<IndexType> &order, std::pmr::vector<std::max_align_t> &scratch) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(order.size() == _componentIds.size());
+			
+			IndexType firstMoved = 0;
+			while (firstMoved < order.size() && order[firstMoved] == firstMoved)
+			{
+				++firstMoved;
+			}
+			if (firstMoved == order.size())
+			{
+				// already in order
+				return;
+			}
+			
+			std::size_t largestVector = 0;
+			for (const internal::DynamicVector &vector : _componentVectors)
+			{
+				largestVector = std::max(largestVector, vector.ByteSize());
+			}
+			const std::size_t scratchSize = (largestVector + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+			if (scratch.size() < scratchSize)
+			{
+				scratch.resize(scratchSize);
+			}
+			
+			std::byte *const buffer = reinterpret_cast<std::byte *>(scratch.data());
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				_componentVectors[i].Reorder(order.data(), _typeInfos[i].size, _constructors[i], buffer);
+			}
+			
+			VectorOf<EntityId> previousIds{_componentIds, &_sparseMemory};
+			for (IndexType row = firstMoved; row < order.size(); ++row)
+			{
+				const EntityId id = previousIds[order[row]];
+				_componentIds[row] = id;
+				_sparse.SetEntry(id, row);
+			}
+		}
+		
+		/// Destructs all components of a row and marks it as a hole
+		/// \param row to remove
+		void MarkAsHole(IndexType row) FLUFF_NOEXCEPT
+		{
+			for (IndexType i = 0; i < _typeInfos.size(); ++i)
+			{
+				_constructors[i].destruct(_componentVectors[i].GetBytes(row * _typeInfos[i].size));
+			}
+			
+			_sparse.MarkAsDeleted(_componentIds[row]);
+			_componentIds[row] = HOLE_ID;
+			
+			if (_holes.empty() || _holes.back() < row) FLUFF_LIKELY
+			{
+				_holes.push_back(row);
+			} else
+			{
+				_holes.insert(std::upper_bound(_holes.cbegin(), _holes.cend(), row), row);
+			}
+		}
+		
 		/// Register multiple entities at once
 		/// \param beginSize size of the container BEFORE the creation of these entities
 		/// \param endSize size of the container AFTER the creation of these entities
@@ -461,6 +1643,14 @@ namespace flf
 				_sparse.SetEntry(index, i);
 				_componentIds[i] = index;
 			}
+
+			if (_group)
+			{
+				for (IndexType i = beginSize; i < endSize; ++i)
+				{
+					_group->AddId(_componentIds[i]);
+				}
+			}
 		}
 
 		/// \return a list of all DynamicVectors that are contained in this
@@ -694,5 +1884,50 @@ namespace flf
 
 		/// Contains vectors of the components
 		VectorOf<internal::DynamicVector> _componentVectors{_ownResource};
+		
+		/// Growth policy and memory accounting of the owning world, applied to all vectors. May be nullptr
+		internal::VectorContext *_vectorContext = nullptr;
+		
+		/// Single allocation for all vectors, if enabled with SetSharedAllocation
+		internal::ColumnArena _arena{&_typeInfos, &_constructors, &_componentVectors};
+
+		/// How single entities are removed
+		RemovalPolicy _removalPolicy = RemovalPolicy::SwapWithLast;
+
+		/// Rows whose entities were removed but not yet compacted, sorted ascending
+		VectorOf<IndexType> _holes{&_sparseMemory};
+
+		/// Entities moved from this container to another one. The destination is kept by its signature, as it may belong
+		/// to another world that is destroyed before this container
+		struct OutgoingMoves
+		{
+			MultiIdType destination = 0;
+			std::size_t entitiesMoved = 0;
+			std::size_t bytesMoved = 0;
+		};
+
+		/// Counts of all transitions to other containers, used for the structural change statistics of the world
+		VectorOf<OutgoingMoves> _outgoingMoves{&_sparseMemory};
+
+		/// Contains the components of the grouped types of all entities in this container. May be nullptr
+		Archetype *_group = nullptr;
+
+		/// Info to the types whose components are saved in _group, sorted by their id
+		VectorOf<TypeInformation> _groupedTypeInfos{_ownResource};
+
+		/// Contains VTables for constructing the grouped types
+		VectorOf<internal::ConstructorVTable> _groupedConstructors{_ownResource};
+		
+		/// Info to the empty types of this container, sorted by their id. They do not have a vector
+		VectorOf<TypeInformation> _tagTypeInfos{_ownResource};
+		
+		/// Contains VTables of the empty types
+		VectorOf<internal::ConstructorVTable> _tagConstructors{_ownResource};
+		
+		/// Types that have a front buffer, see SwapFrontBuffer
+		VectorOf<IdType> _frontTypes{_ownResource};
+		
+		/// The values of the previous frame of the double buffered types, in the same order as _frontTypes
+		VectorOf<internal::DynamicVector> _frontVectors{_ownResource};
 	};
 }
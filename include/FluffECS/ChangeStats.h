@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include "TypeId.h"
+
+namespace flf
+{
+	/// Counts the structural changes of a world, e.g. to find the frames and transitions that cause spikes
+	struct StructuralChangeStats
+	{
+		std::size_t archetypesCreated = 0;
+		/// entities moved from one Archetype to another, e.g. by adding or removing a component
+		std::size_t entitiesMoved = 0;
+		/// bytes of the components moved together with these entities
+		std::size_t bytesMoved = 0;
+		/// new allocations of component vectors, or of shared allocations of Archetypes, when growing or shrinking them
+		std::size_t vectorReallocations = 0;
+		/// reallocations of the sparse arrays that map entity ids to their rows or Archetypes
+		std::size_t sparseResizes = 0;
+	};
+	
+	/// Counts the entities moved along a single transition between two Archetypes
+	struct TransitionStats
+	{
+		/// combined id of all types of the Archetype the entities left
+		MultiIdType source = 0;
+		/// combined id of all types of the Archetype the entities were moved to
+		MultiIdType destination = 0;
+		std::size_t entitiesMoved = 0;
+		std::size_t bytesMoved = 0;
+	};
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+#include <vector>
+#include "Keywords.h"
+#include "TypeId.h"
+#include "DynamicVector.h"
+#include "VirtualConstructor.h"
+
+namespace flf::internal
+{
+	/// Saves all vectors of an Archetype in a single allocation with a shared capacity, one column after the other.
+	/// All columns are grown together, which needs one allocation instead of one per column and keeps the columns
+	/// of an Archetype close to each other in memory
+	class ColumnArena final :
+			public SharedAllocation
+	{
+	public:
+		/// every column starts at a multiple of this, so that no cache line is shared between columns
+		static constexpr std::size_t COLUMN_ALIGNMENT = 64;
+		
+		/// the number of elements reserved when growing without a growth policy, equal to the minimum of DynamicVector
+		static constexpr std::size_t MIN_CAPACITY = 16;
+		
+		/// \param typeInfos of the columns
+		/// \param constructors of the columns
+		/// \param vectors the columns. Have to be in the same order as typeInfos and constructors
+		ColumnArena(const std::pmr::vector<TypeInformation> *typeInfos, const std::pmr::vector<ConstructorVTable> *constructors,
+		            std::pmr::vector<DynamicVector> *vectors) FLUFF_NOEXCEPT
+				: _typeInfos(typeInfos), _constructors(constructors), _vectors(vectors)
+		{
+		}
+		
+		/// \return true when the columns are saved in the shared allocation
+		[[nodiscard]] inline bool IsEnabled() const FLUFF_NOEXCEPT
+		{
+			return _resource != nullptr;
+		}
+		
+		/// Moves all columns into a shared allocation with the capacity of the largest one
+		/// \param resource to allocate the shared memory from
+		/// \param context for the growth policy and accounting. May be nullptr
+		void Enable(std::pmr::memory_resource &resource, VectorContext *context) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(not IsEnabled() && "Shared allocation is already used");
+			_resource = &resource;
+			_context = context;
+			
+			std::size_t capacity = 0;
+			for (std::size_t i = 0; i < _vectors->size(); ++i)
+			{
+				capacity = std::max(capacity, (*_vectors)[i].ByteCapacity() / (*_typeInfos)[i].size);
+			}
+			Relayout(capacity);
+		}
+		
+		/// Moves all columns into memory they allocate on their own and frees the shared allocation
+		void Disable() FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(IsEnabled() && "Shared allocation is not used");
+			for (std::size_t i = 0; i < _vectors->size(); ++i)
+			{
+				(*_vectors)[i].DetachFromShared((*_typeInfos)[i].size, (*_constructors)[i]);
+			}
+			Free();
+			_resource = nullptr;
+			_capacity = 0;
+		}
+		
+		/// Moves the accounting of the shared allocation to another context
+		/// \param context to use from now on. May be nullptr
+		void SetContext(VectorContext *context) FLUFF_NOEXCEPT
+		{
+			Track(_byteCapacity, 0);
+			_context = context;
+			Track(0, _byteCapacity);
+		}
+		
+		/// Grows all columns at once. When the capacity already suffices, only columns that are not yet part of the
+		/// shared allocation are moved into it
+		/// \param minElements number of elements that shall fit into every column afterwards
+		void Grow(std::size_t minElements) FLUFF_MAYBE_NOEXCEPT override
+		{
+			Relayout(minElements <= _capacity ? _capacity : NextCapacity(minElements));
+		}
+		
+		/// Grows all columns at once, if they cannot fit the given number of elements yet
+		/// \param minElements number of elements that shall fit into every column afterwards
+		inline void Reserve(std::size_t minElements) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (minElements > _capacity)
+			{
+				Relayout(NextCapacity(minElements));
+			}
+		}
+		
+		/// Reduces the capacity of all columns at once
+		/// \param capacity to shrink to. Has to fit all elements
+		inline void ShrinkTo(std::size_t capacity) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (capacity < _capacity)
+			{
+				Relayout(capacity);
+			}
+		}
+		
+		/// \return the number of elements that fit into every column
+		[[nodiscard]] inline std::size_t Capacity() const FLUFF_NOEXCEPT
+		{
+			return _capacity;
+		}
+		
+		/// \return the size of the shared allocation in bytes
+		[[nodiscard]] inline std::size_t ByteCapacity() const FLUFF_NOEXCEPT
+		{
+			return _byteCapacity;
+		}
+	
+	private:
+		/// Moves all columns into a new shared allocation
+		/// \param capacity number of elements every column can hold afterwards
+		void Relayout(std::size_t capacity) FLUFF_MAYBE_NOEXCEPT
+		{
+			std::size_t byteCapacity = 0;
+			for (const TypeInformation &tInfo : *_typeInfos)
+			{
+				byteCapacity = AlignUp(byteCapacity) + capacity * tInfo.size;
+			}
+			
+			auto *next = byteCapacity != 0 ? static_cast<std::byte *>(_resource->allocate(byteCapacity, COLUMN_ALIGNMENT)) : nullptr;
+			std::size_t offset = 0;
+			for (std::size_t i = 0; i < _vectors->size(); ++i)
+			{
+				const auto elementSize = (*_typeInfos)[i].size;
+				offset = AlignUp(offset);
+				(*_vectors)[i].MoveToShared(*this, next + offset, capacity * elementSize, elementSize, (*_constructors)[i]);
+				offset += capacity * elementSize;
+			}
+			
+			Track(0, byteCapacity);
+			if (_context != nullptr && next != nullptr)
+			{
+				++_context->changes.vectorReallocations;
+			}
+			Free();
+			_block = next;
+			_byteCapacity = byteCapacity;
+			_capacity = capacity;
+		}
+		
+		/// Frees the shared allocation. No column may use it anymore
+		void Free() FLUFF_NOEXCEPT
+		{
+			if (_block != nullptr)
+			{
+				_resource->deallocate(_block, _byteCapacity, COLUMN_ALIGNMENT);
+			}
+			Track(_byteCapacity, 0);
+			_block = nullptr;
+			_byteCapacity = 0;
+		}
+		
+		/// \param minElements number of elements that have to fit into every column
+		/// \return the capacity to grow to, according to the growth policy
+		[[nodiscard]] inline std::size_t NextCapacity(std::size_t minElements) const FLUFF_NOEXCEPT
+		{
+			if (_context != nullptr)
+			{
+				return _context->growthPolicy.NextCapacity(_capacity, minElements);
+			}
+			return std::max({_capacity * 2, minElements, MIN_CAPACITY});
+		}
+		
+		inline void Track(std::size_t previousByteCapacity, std::size_t nextByteCapacity) const FLUFF_NOEXCEPT
+		{
+			if (_context != nullptr)
+			{
+				_context->OnReallocation(previousByteCapacity, nextByteCapacity);
+			}
+		}
+		
+		[[nodiscard]] inline static constexpr std::size_t AlignUp(std::size_t offset) FLUFF_NOEXCEPT
+		{
+			return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+		}
+	
+	private:
+		const std::pmr::vector<TypeInformation> *_typeInfos;
+		const std::pmr::vector<ConstructorVTable> *_constructors;
+		std::pmr::vector<DynamicVector> *_vectors;
+		
+		/// the resource the shared allocation is taken from, nullptr while the columns allocate on their own
+		std::pmr::memory_resource *_resource = nullptr;
+		VectorContext *_context = nullptr;
+		
+		std::byte *_block = nullptr;
+		std::size_t _byteCapacity = 0;
+		/// number of elements that fit into every column
+		std::size_t _capacity = 0;
+	};
+}
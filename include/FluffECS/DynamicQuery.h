@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <string_view>
+#include "Keywords.h"
+#include "TypeId.h"
+
+namespace flf
+{
+	/// A query whose component types are only known at runtime, e.g. when built by a script or an editor. Entities
+	/// match when they have all With types and none of the Without types. With and Optional types get a column
+	/// each, in the order they were added. Types can be given by id or by name, where the name of a C++ type is its
+	/// fully qualified name and the name of a runtime type is the one it was registered with
+	class DynamicQuery
+	{
+	public:
+		/// Requires the entities to have a component of a type
+		/// \param type id of the type
+		/// \return this query
+		DynamicQuery &With(IdType type) FLUFF_MAYBE_NOEXCEPT
+		{
+			_columnTypes.push_back(type);
+			_required.insert(std::upper_bound(_required.cbegin(), _required.cend(), type), type);
+			return *this;
+		}
+		
+		/// Requires the entities to have a component of a type
+		/// \param name of the type
+		/// \return this query
+		DynamicQuery &With(std::string_view name) FLUFF_MAYBE_NOEXCEPT
+		{
+			return With(internal::HashString(name));
+		}
+		
+		/// Excludes all entities with a component of a type. The type does not get a column
+		/// \param type id of the type
+		/// \return this query
+		DynamicQuery &Without(IdType type) FLUFF_MAYBE_NOEXCEPT
+		{
+			_excluded.push_back(type);
+			return *this;
+		}
+		
+		/// Excludes all entities with a component of a type. The type does not get a column
+		/// \param name of the type
+		/// \return this query
+		DynamicQuery &Without(std::string_view name) FLUFF_MAYBE_NOEXCEPT
+		{
+			return Without(internal::HashString(name));
+		}
+		
+		/// Adds a column for a type that the entities may have. The column is nullptr for entities without it
+		/// \param type id of the type
+		/// \return this query
+		DynamicQuery &Optional(IdType type) FLUFF_MAYBE_NOEXCEPT
+		{
+			_columnTypes.push_back(type);
+			++_nOptional;
+			return *this;
+		}
+		
+		/// Adds a column for a type that the entities may have. The column is nullptr for entities without it
+		/// \param name of the type
+		/// \return this query
+		DynamicQuery &Optional(std::string_view name) FLUFF_MAYBE_NOEXCEPT
+		{
+			return Optional(internal::HashString(name));
+		}
+		
+		/// \return the types that get a column, in the order they were added
+		[[nodiscard]] inline const std::vector<IdType> &GetColumnTypes() const FLUFF_NOEXCEPT
+		{
+			return _columnTypes;
+		}
+		
+		/// \return the With types, sorted by their id
+		[[nodiscard]] inline const std::vector<IdType> &GetRequired() const FLUFF_NOEXCEPT
+		{
+			return _required;
+		}
+		
+		/// \return the Without types
+		[[nodiscard]] inline const std::vector<IdType> &GetExcluded() const FLUFF_NOEXCEPT
+		{
+			return _excluded;
+		}
+		
+		/// \return true when two entities of the same group might differ in what the query yields for them
+		[[nodiscard]] inline bool HasFilters() const FLUFF_NOEXCEPT
+		{
+			return not _excluded.empty() || _nOptional != 0;
+		}
+	
+	private:
+		std::vector<IdType> _columnTypes{};
+		std::vector<IdType> _required{};
+		std::vector<IdType> _excluded{};
+		std::size_t _nOptional = 0;
+	};
+}
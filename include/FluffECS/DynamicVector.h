@@ -3,17 +3,92 @@
 #include <cstddef>
 #include <cassert>
 #include <cstring>
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <memory_resource>
 #include "Keywords.h"
 #include "VirtualConstructor.h"
+#include "ChangeStats.h"
 
 /// may be commented out to increase performance when NDEBUG is not defined
 //#define FLUFF_DO_RANGE_CHECKS
 
+namespace flf
+{
+	/// Describes how the component vectors of a world grow when they are full and when they give memory back
+	struct GrowthPolicy
+	{
+		/// the capacity is multiplied by this factor when a vector is full
+		double factor = 2.0;
+		/// number of elements added on top of the multiplied capacity. Use factor = 1 for purely linear growth
+		std::size_t increment = 0;
+		/// maximum number of elements a single growth step may add, 0 for no limit
+		std::size_t maxStep = 0;
+		/// vectors are trimmed after removals when less than this fraction of their capacity is used, 0 disables trimming.
+		/// Should be smaller than 1 / factor, otherwise a vector may be trimmed and grown again over and over
+		double shrinkThreshold = 0.0;
+		
+		/// \param capacity number of elements that currently fit into the vector
+		/// \param required number of elements that have to fit into the vector afterwards
+		/// \return the number of elements the vector shall be able to hold afterwards
+		[[nodiscard]] std::size_t NextCapacity(std::size_t capacity, std::size_t required) const FLUFF_NOEXCEPT
+		{
+			auto next = static_cast<std::size_t>(static_cast<double>(capacity) * factor) + increment;
+			if (maxStep != 0 && next > capacity + maxStep)
+			{
+				next = capacity + maxStep;
+			}
+			return std::max(next, required);
+		}
+	};
+}
+
 namespace flf::internal
 {
+	/// Growth policy and memory accounting shared by all vectors of a world
+	struct VectorContext
+	{
+		GrowthPolicy growthPolicy{};
+		/// bytes currently reserved by all vectors using this context
+		std::size_t byteCapacity = 0;
+		/// the largest value byteCapacity ever had
+		std::size_t peakByteCapacity = 0;
+		/// structural changes of the owning world, counted by the vectors, Archetypes and sparse sets using this context
+		StructuralChangeStats changes{};
+		
+		/// Updates the accounting after a vector changed its capacity
+		/// \param previousByteCapacity of the vector
+		/// \param nextByteCapacity of the vector
+		inline void OnReallocation(std::size_t previousByteCapacity, std::size_t nextByteCapacity) FLUFF_NOEXCEPT
+		{
+			byteCapacity = byteCapacity - previousByteCapacity + nextByteCapacity;
+			peakByteCapacity = std::max(peakByteCapacity, byteCapacity);
+		}
+		
+		/// Updates the accounting after a vector moved its elements into a new allocation
+		/// \param previousByteCapacity of the vector
+		/// \param nextByteCapacity of the vector
+		inline void OnNewAllocation(std::size_t previousByteCapacity, std::size_t nextByteCapacity) FLUFF_NOEXCEPT
+		{
+			OnReallocation(previousByteCapacity, nextByteCapacity);
+			++changes.vectorReallocations;
+		}
+	};
+	
+	/// Owner of a single allocation that is split between several vectors of the same capacity. Vectors using it never
+	/// allocate on their own, but let the owner grow all of them at once
+	class SharedAllocation
+	{
+	public:
+		/// Grows the capacity of all vectors using this allocation
+		/// \param minElements number of elements that shall fit into every vector afterwards
+		virtual void Grow(std::size_t minElements) FLUFF_MAYBE_NOEXCEPT = 0;
+	
+	protected:
+		~SharedAllocation() = default;
+	};
+	
 	/// A vector implementation that only stores bytes
 	class ByteVector
 	{
@@ -140,43 +215,255 @@ namespace flf::internal
 			_sizeEnd += elementSize;
 		}
 		
-		// TODO: does not seem to work correctly
-		void ReserveUsing(const size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		/// Copies value to the end of the vector count times. Trivially copyable types are filled with a doubling pattern of memcpy calls
+		/// \param value to copy from. May be an element of this vector
+		/// \param count number of copies
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for copying
+		void FillUsing(const void *value, const std::size_t count, const std::size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
 		{
-			const auto previousCapacity = ByteCapacity();
-			const auto nextByteCapacity = NextSize((previousCapacity / elementSize)) * elementSize;
-			
-			auto *next = reinterpret_cast<std::byte *>(_resource->allocate(nextByteCapacity));
-			
-			assert(constructors.destruct != nullptr);
+			if (count == 0)
+			{
+				return;
+			}
 			
-			if (constructors.moveConstruct != nullptr)
+			const std::size_t byteCount = count * elementSize;
+			if (_sizeEnd + byteCount > _capacityEnd)
 			{
-				for (std::byte *begin = std::launder(_begin), *const end = _sizeEnd, *target = next; begin < end; begin += elementSize, target += elementSize)
+				// the value might be moved by the reallocation
+				const auto *valueBytes = static_cast<const std::byte *>(value);
+				const bool isOwnElement = valueBytes >= _begin && valueBytes < _sizeEnd;
+				const std::size_t valueOffset = isOwnElement ? valueBytes - _begin : 0;
+				
+				ReserveUsing(elementSize, constructors, ByteSize() / elementSize + count);
+				if (isOwnElement)
 				{
-					constructors.moveConstruct(begin, target);
-					constructors.destruct(begin);
+					value = _begin + valueOffset;
 				}
-			} else if (constructors.copyConstruct != nullptr)
+			}
+			
+			std::byte *const first = _sizeEnd;
+			if (constructors.isTriviallyCopyable)
 			{
-				for (std::byte *begin = std::launder(_begin), *const end = _sizeEnd, *target = next; begin < end; begin += elementSize, target += elementSize)
+				// copy the value once, then double the filled range with every copy
+				std::memcpy(first, value, elementSize);
+				std::size_t filled = elementSize;
+				while (filled < byteCount)
 				{
-					constructors.copyConstruct(begin, target);
-					constructors.destruct(begin);
+					const std::size_t chunk = std::min(filled, byteCount - filled);
+					std::memcpy(first + filled, first, chunk);
+					filled += chunk;
 				}
 			} else
 			{
-				assert(false && "Type has neither move nor copy constructor");
-				// TODO: throw an exception
+				assert(constructors.copyConstruct);
+				for (std::byte *target = first, *const end = first + byteCount; target < end; target += elementSize)
+				{
+					constructors.copyConstruct(target, const_cast<void *>(value));
+				}
+			}
+			_sizeEnd += byteCount;
+		}
+		
+		/// Default constructs multiple elements at the end of the vector, growing its capacity at most once
+		/// \param count number of elements to add
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for construction
+		void GrowUsing(const std::size_t count, const std::size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			const std::size_t byteCount = count * elementSize;
+			if (_sizeEnd + byteCount > _capacityEnd)
+			{
+				ReserveUsing(elementSize, constructors, ByteSize() / elementSize + count);
+			}
+			
+			assert(constructors.defaultConstruct);
+			for (std::byte *target = _sizeEnd, *const end = _sizeEnd + byteCount; target < end; target += elementSize)
+			{
+				constructors.defaultConstruct(target);
+			}
+			_sizeEnd += byteCount;
+		}
+		
+		/// Moves all elements of another vector to the end of this one, growing the capacity at most once. The other
+		/// vector is left empty, but keeps its capacity
+		/// \param other vector containing elements of the same type
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		void AppendMovedUsing(ByteVector &other, const std::size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			const std::size_t byteCount = other.ByteSize();
+			if (byteCount == 0)
+			{
+				return;
+			}
+			
+			if (_sizeEnd + byteCount > _capacityEnd)
+			{
+				ReserveUsing(elementSize, constructors, (ByteSize() + byteCount) / elementSize);
+			}
+			
+			other.MoveElements(_sizeEnd, elementSize, constructors);
+			other._sizeEnd = other._begin;
+			_sizeEnd += byteCount;
+		}
+		
+		/// Destructs all elements, keeping the capacity
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for destructing the elements
+		void ClearUsing(const std::size_t elementSize, const ConstructorVTable &constructors) FLUFF_NOEXCEPT
+		{
+			if (not constructors.isTriviallyDestructible)
+			{
+				for (std::byte *element = _begin; element < _sizeEnd; element += elementSize)
+				{
+					constructors.destruct(element);
+				}
+			}
+			_sizeEnd = _begin;
+		}
+		
+		/// Grows the capacity of the vector, moving all elements using the given constructors
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		/// \param minElements number of elements that shall fit into the vector afterwards, at least one more than before
+		void ReserveUsing(const size_t elementSize, const ConstructorVTable &constructors, const std::size_t minElements = 0) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto previousElements = ByteCapacity() / elementSize;
+			if (_owner != nullptr)
+			{
+				_owner->Grow(std::max(previousElements + 1, minElements));
+				return;
+			}
+			Reallocate(NextCapacity(previousElements, std::max(previousElements + 1, minElements)) * elementSize, elementSize, constructors);
+		}
+		
+		/// Reduces the capacity to the current size, or to minElements if that is larger
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		/// \param minElements number of elements that shall still fit into the vector afterwards
+		void ShrinkToFitUsing(const size_t elementSize, const ConstructorVTable &constructors, const std::size_t minElements = 0) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(_owner == nullptr && "Vectors of a shared allocation can only be shrunk by its owner");
+			const auto nextByteCapacity = std::max(ByteSize(), minElements * elementSize);
+			if (nextByteCapacity >= ByteCapacity())
+			{
+				return;
 			}
 			
+			if (nextByteCapacity == 0)
+			{
+				Release();
+			} else
+			{
+				Reallocate(nextByteCapacity, elementSize, constructors);
+			}
+		}
+		
+		/// Sets the growth policy and accounting used by this vector. The current capacity is moved from the previous context to the new one
+		/// \param context to use from now on. May be nullptr to always grow to the next power of 2
+		void SetContext(VectorContext *context) FLUFF_NOEXCEPT
+		{
+			TrackCapacity(ByteCapacity(), 0);
+			_context = context;
+			TrackCapacity(0, ByteCapacity());
+		}
+		
+		/// Moves all elements into a part of a shared allocation. Frees the memory the vector allocated on its own, if any
+		/// \param owner of the shared allocation
+		/// \param next part of the shared allocation to use from now on
+		/// \param nextByteCapacity size of that part. Has to fit all elements
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		void MoveToShared(SharedAllocation &owner, std::byte *next, const std::size_t nextByteCapacity, const std::size_t elementSize,
+		                  const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(nextByteCapacity >= ByteSize());
+			const auto previousSize = ByteSize();
+			if (_owner == nullptr)
+			{
+				Release(next, elementSize, constructors);
+			} else
+			{
+				MoveElements(next, elementSize, constructors);
+			}
 			
-			_resource->deallocate(_begin, previousCapacity);
+			_owner = &owner;
 			_begin = next;
-			_sizeEnd = next + previousCapacity;
+			_sizeEnd = next + previousSize;
 			_capacityEnd = next + nextByteCapacity;
 		}
 		
+		/// Moves all elements out of the shared allocation into memory of the same capacity that this vector allocates on its own
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		void DetachFromShared(const std::size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(_owner != nullptr && "Vector does not use a shared allocation");
+			const auto size = ByteSize();
+			const auto byteCapacity = ByteCapacity();
+			auto *next = byteCapacity != 0 ? reinterpret_cast<std::byte *>(_resource->allocate(byteCapacity)) : nullptr;
+			MoveElements(next, elementSize, constructors);
+			
+			_owner = nullptr;
+			_begin = next;
+			_sizeEnd = next + size;
+			_capacityEnd = next + byteCapacity;
+			TrackCapacity(0, byteCapacity);
+		}
+		
+		/// Frees the memory of the vector. All elements need to have been destructed before. A vector using a shared allocation
+		/// only stops using it, the memory is freed by the owner
+		void Release() FLUFF_NOEXCEPT
+		{
+			if (_begin != nullptr && _owner == nullptr)
+			{
+				TrackCapacity(ByteCapacity(), 0);
+				_resource->deallocate(_begin, ByteCapacity());
+			}
+			_owner = nullptr;
+			_begin = nullptr;
+			_sizeEnd = nullptr;
+			_capacityEnd = nullptr;
+		}
+		
+		/// Reorders the elements, so that the element previously at order[i] is at position i afterwards. The elements are
+		/// ordered in a scratch buffer and moved back, so the vector keeps its allocation
+		/// \param order permutation of all element indices, needs to contain ByteSize() / elementSize entries
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		/// \param scratch memory for at least ByteSize() bytes, aligned like the allocations of the vector
+		void Reorder(const std::size_t *order, const std::size_t elementSize, const ConstructorVTable &constructors, std::byte *scratch) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto byteSize = ByteSize();
+			for (std::byte *target = scratch, *const targetEnd = scratch + byteSize; target < targetEnd; target += elementSize, ++order)
+			{
+				std::byte *source = _begin + *order * elementSize;
+				if (constructors.isTriviallyCopyable)
+				{
+					std::memcpy(target, source, elementSize);
+				} else
+				{
+					if (constructors.moveConstruct != nullptr)
+					{
+						constructors.moveConstruct(target, source);
+					} else
+					{
+						constructors.copyConstruct(target, source);
+					}
+					constructors.destruct(source);
+				}
+			}
+			
+			// the ordered elements are moved back by looking at the scratch buffer as if it was the vector
+			std::byte *const own = _begin;
+			_begin = scratch;
+			_sizeEnd = scratch + byteSize;
+			MoveElements(own, elementSize, constructors);
+			_begin = own;
+			_sizeEnd = own + byteSize;
+		}
+		
 		/// Reduces the size of the vector by size bytes
 		/// \param size
 		void PopBackBytes(std::size_t size) FLUFF_NOEXCEPT
@@ -188,8 +475,82 @@ namespace flf::internal
 		{
 			return _begin + offset;
 		}
+		
+		[[nodiscard]] const void *GetBytes(std::size_t offset) const FLUFF_NOEXCEPT
+		{
+			return _begin + offset;
+		}
 	
 	protected:
+		/// Moves all elements into a new allocation of the given size
+		/// \param nextByteCapacity size of the new allocation. Has to fit all elements
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		void Reallocate(const std::size_t nextByteCapacity, const size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(nextByteCapacity >= ByteSize());
+			const auto previousSize = ByteSize();
+			const auto previousCapacity = ByteCapacity();
+			
+			auto *next = reinterpret_cast<std::byte *>(_resource->allocate(nextByteCapacity));
+			MoveElements(next, elementSize, constructors);
+			
+			if (_begin != nullptr)
+			{
+				_resource->deallocate(_begin, previousCapacity);
+			}
+			_begin = next;
+			_sizeEnd = next + previousSize;
+			_capacityEnd = next + nextByteCapacity;
+			TrackAllocation(previousCapacity, nextByteCapacity);
+		}
+		
+		/// Frees the own memory of the vector after moving all elements to another place
+		/// \param next memory to move the elements to
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		void Release(std::byte *next, const std::size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			MoveElements(next, elementSize, constructors);
+			Release();
+		}
+		
+		/// Moves all elements to another place, destructing the previous ones. Does not change the vector itself
+		/// \param next memory to move the elements to. Has to fit all elements
+		/// \param elementSize equal to sizeof(T)
+		/// \param constructors to use for moving the elements
+		void MoveElements(std::byte *next, const std::size_t elementSize, const ConstructorVTable &constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto previousSize = ByteSize();
+			assert(constructors.destruct != nullptr);
+			
+			if (constructors.isTriviallyCopyable)
+			{
+				// an empty vector may not have an allocation yet, and memcpy may not be called with nullptr
+				if (previousSize != 0)
+				{
+					std::memcpy(next, _begin, previousSize);
+				}
+			} else if (constructors.moveConstruct != nullptr)
+			{
+				for (std::byte *begin = std::launder(_begin), *const end = _sizeEnd, *target = next; begin < end; begin += elementSize, target += elementSize)
+				{
+					constructors.moveConstruct(target, begin);
+					constructors.destruct(begin);
+				}
+			} else if (constructors.copyConstruct != nullptr)
+			{
+				for (std::byte *begin = std::launder(_begin), *const end = _sizeEnd, *target = next; begin < end; begin += elementSize, target += elementSize)
+				{
+					constructors.copyConstruct(target, begin);
+					constructors.destruct(begin);
+				}
+			} else
+			{
+				assert(false && "Type has neither move nor copy constructor");
+				// TODO: throw an exception
+			}
+		}
 		
 		/// Grows the vector by increasing the number of components that can be saved whose sizeof() equals byteSize by one
 		/// \param byteSize of the components saved here
@@ -207,12 +568,50 @@ namespace flf::internal
 			const auto nextCapacity = nBytes;
 			auto *next = reinterpret_cast<std::byte *>(_resource->allocate(nextCapacity));
 			
-			std::memcpy(next, _begin, previousSize);
+			if (previousSize != 0)
+			{
+				std::memcpy(next, _begin, previousSize);
+			}
 			_begin = next;
 			_sizeEnd = _begin + previousSize;
 			_capacityEnd = _begin + nextCapacity;
 		}
 		
+		/// Applies the growth policy of the context, or grows to the next power of 2 when there is none
+		/// \param capacity number of elements that currently fit into the vector
+		/// \param required number of elements that have to fit into the vector afterwards
+		/// \return the number of elements the capacity should grow to
+		[[nodiscard]] inline std::size_t NextCapacity(std::size_t capacity, std::size_t required) const FLUFF_NOEXCEPT
+		{
+			if (_context == nullptr) FLUFF_LIKELY
+			{
+				return NextSize(required);
+			}
+			return _context->growthPolicy.NextCapacity(capacity, required);
+		}
+		
+		/// Reports a change of the capacity to the context
+		/// \param previousByteCapacity of this vector
+		/// \param nextByteCapacity of this vector
+		inline void TrackCapacity(std::size_t previousByteCapacity, std::size_t nextByteCapacity) const FLUFF_NOEXCEPT
+		{
+			if (_context != nullptr && _owner == nullptr)
+			{
+				_context->OnReallocation(previousByteCapacity, nextByteCapacity);
+			}
+		}
+		
+		/// Reports a new allocation of this vector to the context
+		/// \param previousByteCapacity of this vector
+		/// \param nextByteCapacity of this vector
+		inline void TrackAllocation(std::size_t previousByteCapacity, std::size_t nextByteCapacity) const FLUFF_NOEXCEPT
+		{
+			if (_context != nullptr && _owner == nullptr)
+			{
+				_context->OnNewAllocation(previousByteCapacity, nextByteCapacity);
+			}
+		}
+		
 		/// Growth policy of the vector. Returns the next power of 2 that is equal to or larger than n
 		/// \param n amount we want to at least store.
 		/// \return the size the capacity should grow to
@@ -240,6 +639,10 @@ namespace flf::internal
 		std::byte *_sizeEnd{};
 		/// end of the allocated memory for the vector. note that only the byte before _capacityEnd is usable
 		std::byte *_capacityEnd{};
+		/// growth policy and accounting of the owning world. May be nullptr
+		VectorContext *_context{};
+		/// owner of the memory of this vector when it is part of a shared allocation, nullptr when the vector allocates on its own
+		SharedAllocation *_owner{};
 	};
 	
 	class DynamicVector :
@@ -263,6 +666,7 @@ namespace flf::internal
 				std::destroy_at(current);
 			}
 			
+			TrackCapacity(ByteCapacity(), 0);
 			_resource->deallocate(_begin, ByteCapacity());
 			
 			_sizeEnd = _begin;
@@ -442,10 +846,15 @@ namespace flf::internal
 				// already can contain this many elements
 				return;
 			}
+			if (_owner != nullptr)
+			{
+				_owner->Grow(number);
+				return;
+			}
 			
 			const auto byteSize = ByteSize();
 			const auto previousByteCapacity = ByteCapacity();
-			auto nextCapacity = NextSize(number) * sizeof(T);
+			auto nextCapacity = NextCapacity(Capacity<T>(), number) * sizeof(T);
 			if (nextCapacity < MIN_OBJECT_COUNT * sizeof(T))
 			{
 				nextCapacity = MIN_OBJECT_COUNT * sizeof(T);
@@ -458,7 +867,10 @@ namespace flf::internal
 			if constexpr (std::is_trivially_move_constructible_v<T>)
 			{
 				// optimization: we can just copy the whole memory block over
-				std::memcpy(next, _begin, byteSize);
+				if (byteSize != 0)
+				{
+					std::memcpy(next, _begin, byteSize);
+				}
 			} else
 			{
 				for (T *target = reinterpret_cast<T *>(next), *const targetEnd = target + (byteSize / sizeof(T)), *source = std::launder(
@@ -484,11 +896,15 @@ namespace flf::internal
 				}
 			}
 			
-			_resource->deallocate(_begin, previousByteCapacity);
+			if (_begin != nullptr)
+			{
+				_resource->deallocate(_begin, previousByteCapacity);
+			}
 			
 			_begin = next;
 			_sizeEnd = _begin + byteSize;
 			_capacityEnd = _begin + nextCapacity;
+			TrackAllocation(previousByteCapacity, nextCapacity);
 		}
 		
 		/// Sets Size<T> = size and does a reallocation if necessary
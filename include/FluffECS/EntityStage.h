@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+#include "Keywords.h"
+#include "TypeId.h"
+#include "TypeList.h"
+#include "Entity.h"
+#include "DynamicVector.h"
+#include "VirtualConstructor.h"
+#include "WorldInternal.h"
+
+namespace flf
+{
+	namespace internal
+	{
+		/// The staged entities of a single Archetype, saved column by column like in the Archetype itself
+		struct StagedArchetype
+		{
+			MultiIdType signature = 0;
+			std::pmr::vector<TypeInformation> typeInfos;
+			std::pmr::vector<ConstructorVTable> constructors;
+			/// one per type in typeInfos, tags have an empty column
+			std::pmr::vector<DynamicVector> columns;
+			std::pmr::vector<EntityId> ids;
+			
+			/// \param type id of a type of this Archetype
+			/// \return the column of that type
+			[[nodiscard]] inline DynamicVector &ColumnOf(IdType type) FLUFF_NOEXCEPT
+			{
+				for (std::size_t i = 0; i < typeInfos.size(); ++i)
+				{
+					if (typeInfos[i].id == type)
+					{
+						return columns[i];
+					}
+				}
+				assert(false && "Type is not part of the staged Archetype");
+				return columns.front();
+			}
+		};
+	}
+	
+	/// Creates entities outside of a world, so that worker threads can spawn entities without synchronization. Every
+	/// thread uses its own stage: ids are reserved from the world atomically in blocks, and the components are collected
+	/// per Archetype in columns owned by the stage. At a sync point, BasicWorld::Merge moves all staged entities into the
+	/// world with one bulk append per column. The stage keeps its memory, so staging the same amounts every frame does not
+	/// allocate. A stage may be used while the world is iterated, but not while the world is changed structurally
+	class EntityStage
+	{
+	public:
+		/// number of ids reserved from the world at once
+		static constexpr EntityId DEFAULT_ID_BLOCK_SIZE = 256;
+		
+		/// Use BasicWorld::CreateStage instead
+		/// \param world to reserve the ids in
+		/// \param resource to allocate the staged components from. Has to be thread safe if the stage is used on multiple threads
+		/// \param idBlockSize number of ids to reserve from the world at once
+		EntityStage(internal::WorldInternal &world, std::pmr::memory_resource &resource, EntityId idBlockSize) FLUFF_NOEXCEPT
+				: _world(&world), _resource(&resource), _idBlockSize(idBlockSize), _archetypes(&resource)
+		{
+			assert(idBlockSize != 0 && "Need to reserve at least one id at once");
+		}
+		
+		EntityStage(const EntityStage &) = delete;
+		
+		EntityStage(EntityStage &&) FLUFF_NOEXCEPT = default;
+		
+		EntityStage &operator=(const EntityStage &) = delete;
+		
+		~EntityStage() FLUFF_NOEXCEPT
+		{
+			Clear();
+			for (internal::StagedArchetype &staged : _archetypes)
+			{
+				for (internal::DynamicVector &column : staged.columns)
+				{
+					column.Release();
+				}
+			}
+		}
+		
+		/// Stages an entity with the given components. The entity is part of the world after the next BasicWorld::Merge
+		/// \tparam TComponents of the entity. May not be declared sparse in the world
+		/// \param components of the entity
+		/// \return the id the entity will have in the world
+		template<typename ...TComponents>
+		EntityId CreateEntity(TComponents &&...components) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert((not std::is_pointer_v<std::decay_t<TComponents>> && ...), "Type cannot be a pointer");
+			
+			internal::StagedArchetype &staged = StagedArchetypeOf<std::decay_t<TComponents>...>();
+			(EmplaceInto<std::decay_t<TComponents>>(staged, std::forward<TComponents>(components)), ...);
+			
+			if (_nextId == _idEnd) FLUFF_UNLIKELY
+			{
+				_nextId = _world->ReserveIds(_idBlockSize);
+				_idEnd = _nextId + _idBlockSize;
+			}
+			staged.ids.push_back(_nextId);
+			return _nextId++;
+		}
+		
+		/// \return the number of staged entities
+		[[nodiscard]] std::size_t Size() const FLUFF_NOEXCEPT
+		{
+			std::size_t size = 0;
+			for (const internal::StagedArchetype &staged : _archetypes)
+			{
+				size += staged.ids.size();
+			}
+			return size;
+		}
+		
+		/// Destroys all staged entities without adding them to the world. Their ids stay unused
+		void Clear() FLUFF_NOEXCEPT
+		{
+			for (internal::StagedArchetype &staged : _archetypes)
+			{
+				for (std::size_t i = 0; i < staged.columns.size(); ++i)
+				{
+					staged.columns[i].ClearUsing(staged.typeInfos[i].size, staged.constructors[i]);
+				}
+				staged.ids.clear();
+			}
+		}
+		
+		/// \return the staged entities of every Archetype, used by BasicWorld::Merge
+		[[nodiscard]] inline std::pmr::vector<internal::StagedArchetype> &GetStagedArchetypes() FLUFF_NOEXCEPT
+		{
+			return _archetypes;
+		}
+	
+	private:
+		/// Looks up the staged Archetype with exactly the given types, or adds it
+		/// \tparam TComponents types of the Archetype
+		/// \return the staged Archetype
+		template<typename ...TComponents>
+		internal::StagedArchetype &StagedArchetypeOf() FLUFF_MAYBE_NOEXCEPT
+		{
+			constexpr MultiIdType signature = MultiTypeId<TComponents...>();
+			// a thread usually spawns only a few kinds of entities, so a linear search is faster than a map
+			const auto found = std::find_if(_archetypes.begin(), _archetypes.end(),
+			                                [](const internal::StagedArchetype &staged) { return staged.signature == signature; });
+			if (found != _archetypes.end()) FLUFF_LIKELY
+			{
+				return *found;
+			}
+			
+			return AddStagedArchetype(signature, internal::Sort(internal::TypeList<TComponents...>()));
+		}
+		
+		/// Adds a staged Archetype. Its columns are sorted by type id like the ones of the Archetypes of the world, which
+		/// relies on that order when the Archetype is created by BasicWorld::Merge
+		/// \param signature combined id of the types
+		/// \return the added staged Archetype
+		template<typename ...TComponents>
+		internal::StagedArchetype &AddStagedArchetype(MultiIdType signature, internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT
+		{
+			internal::StagedArchetype &staged = _archetypes.emplace_back(internal::StagedArchetype{
+					signature, std::pmr::vector<TypeInformation>{{TypeInformation::Of<TComponents>()...}, _resource},
+					std::pmr::vector<internal::ConstructorVTable>{{internal::ConstructorVTable::Of<TComponents>()...}, _resource},
+					std::pmr::vector<internal::DynamicVector>{sizeof...(TComponents), internal::DynamicVector(*_resource), _resource},
+					std::pmr::vector<EntityId>{_resource}});
+			return staged;
+		}
+		
+		/// Adds a component to its column. Does nothing for tags
+		/// \tparam TComponent type of the component
+		/// \param staged Archetype of the entity
+		/// \param component to add
+		template<typename TComponent, typename TArg>
+		static void EmplaceInto(internal::StagedArchetype &staged, TArg &&component) FLUFF_MAYBE_NOEXCEPT
+		{
+			if constexpr (not internal::IsEmpty<TComponent>)
+			{
+				staged.ColumnOf(TypeId<TComponent>()).template EmplaceBack<TComponent>(std::forward<TArg>(component));
+			}
+		}
+	
+	private:
+		internal::WorldInternal *_world;
+		std::pmr::memory_resource *_resource;
+		EntityId _idBlockSize;
+		
+		/// the next id to hand out from the reserved block
+		EntityId _nextId = 0;
+		/// the end of the reserved block
+		EntityId _idEnd = 0;
+		
+		std::pmr::vector<internal::StagedArchetype> _archetypes;
+	};
+}
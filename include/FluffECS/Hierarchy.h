@@ -0,0 +1,358 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <limits>
+#include "Keywords.h"
+#include "Entity.h"
+#include "SparseSet.h"
+
+namespace flf::internal
+{
+	/// Saves parent/child relationships between entities. All entities that are part of the hierarchy are kept in a
+	/// single array that is sorted by depth on demand, so walking it visits every parent before its children
+	class Hierarchy
+	{
+	public:
+		using IndexType = std::size_t;
+		
+		/// marks a missing parent, child or sibling
+		static constexpr EntityId NO_ENTITY = std::numeric_limits<EntityId>::max();
+		
+		struct Node
+		{
+			EntityId id = NO_ENTITY;
+			EntityId parent = NO_ENTITY;
+			EntityId firstChild = NO_ENTITY;
+			EntityId nextSibling = NO_ENTITY;
+			EntityId previousSibling = NO_ENTITY;
+			IndexType depth = 0;
+			/// index of the parent in the nodes sorted by depth, only valid while they are sorted
+			IndexType parentIndex = 0;
+		};
+	
+	public:
+		explicit Hierarchy(std::pmr::memory_resource &sparseResource) FLUFF_NOEXCEPT
+				: _nodes(&sparseResource), _sparse(sparseResource)
+		{
+		}
+		
+		/// \return true when no entity has a parent
+		[[nodiscard]] inline bool Empty() const FLUFF_NOEXCEPT
+		{
+			return _nodes.empty();
+		}
+		
+		/// \param id of the entity
+		/// \return true when the entity has a parent or children
+		[[nodiscard]] inline bool Contains(EntityId id) const FLUFF_NOEXCEPT
+		{
+			return _sparse.Contains(id);
+		}
+		
+		/// \param id of the entity
+		/// \return the parent of the entity or NO_ENTITY if it has none
+		[[nodiscard]] inline EntityId ParentOf(EntityId id) const FLUFF_NOEXCEPT
+		{
+			return Contains(id) ? NodeOf(id).parent : NO_ENTITY;
+		}
+		
+		/// \param id of the entity
+		/// \return the number of ancestors of the entity
+		[[nodiscard]] inline IndexType DepthOf(EntityId id) const FLUFF_NOEXCEPT
+		{
+			return Contains(id) ? NodeOf(id).depth : 0;
+		}
+		
+		/// \param id of the entity to check
+		/// \param ancestor that might be a direct or indirect parent of id
+		/// \return true when ancestor is a direct or indirect parent of id
+		[[nodiscard]] bool IsDescendantOf(EntityId id, EntityId ancestor) const FLUFF_NOEXCEPT
+		{
+			for (EntityId current = ParentOf(id); current != NO_ENTITY; current = ParentOf(current))
+			{
+				if (current == ancestor)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+		
+		/// Makes child a direct child of parent, detaching it from its previous parent
+		/// \param child to attach
+		/// \param parent to attach to. May not be a descendant of child
+		void SetParent(EntityId child, EntityId parent) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(child != parent && "An entity cannot be its own parent");
+			assert(not IsDescendantOf(parent, child) && "Relationship would create a cycle");
+			
+			AddNode(child);
+			AddNode(parent);
+			Unlink(child);
+			
+			Node &parentNode = NodeOf(parent);
+			Node &childNode = NodeOf(child);
+			childNode.parent = parent;
+			childNode.nextSibling = parentNode.firstChild;
+			if (parentNode.firstChild != NO_ENTITY)
+			{
+				NodeOf(parentNode.firstChild).previousSibling = child;
+			}
+			parentNode.firstChild = child;
+			
+			UpdateDepths(child, parentNode.depth + 1);
+		}
+		
+		/// Detaches an entity from its parent, its own children stay attached to it
+		/// \param child to detach
+		void RemoveParent(EntityId child) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (not Contains(child))
+			{
+				return;
+			}
+			
+			const EntityId parent = NodeOf(child).parent;
+			Unlink(child);
+			UpdateDepths(child, 0);
+			RemoveIfUnused(child);
+			if (parent != NO_ENTITY)
+			{
+				RemoveIfUnused(parent);
+			}
+		}
+		
+		/// Removes all relationships at once
+		void Clear() FLUFF_NOEXCEPT
+		{
+			for (const Node &node : _nodes)
+			{
+				_sparse.MarkAsDeleted(node.id);
+			}
+			_nodes.clear();
+			_isSorted = true;
+		}
+		
+		/// Removes an entity from the hierarchy, e.g. because it is destroyed. Its children lose their parent
+		/// \param id of the entity
+		void Remove(EntityId id) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (not Contains(id))
+			{
+				return;
+			}
+			
+			const EntityId parent = NodeOf(id).parent;
+			Unlink(id);
+			
+			for (EntityId child = NodeOf(id).firstChild; child != NO_ENTITY;)
+			{
+				Node &childNode = NodeOf(child);
+				const EntityId next = childNode.nextSibling;
+				childNode.parent = NO_ENTITY;
+				childNode.nextSibling = NO_ENTITY;
+				childNode.previousSibling = NO_ENTITY;
+				UpdateDepths(child, 0);
+				RemoveIfUnused(child);
+				child = next;
+			}
+			NodeOf(id).firstChild = NO_ENTITY;
+			
+			RemoveIfUnused(id);
+			if (parent != NO_ENTITY)
+			{
+				RemoveIfUnused(parent);
+			}
+		}
+		
+		/// Calls function for every direct child of parent. The hierarchy may not be changed during the iteration
+		/// \param parent whose children are visited
+		/// \param function callable with signature void(EntityId)
+		template<typename TFunc>
+		void ForeachChild(EntityId parent, TFunc &&function) const FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, EntityId>)
+		{
+			if (not Contains(parent))
+			{
+				return;
+			}
+			
+			for (EntityId child = NodeOf(parent).firstChild; child != NO_ENTITY; child = NodeOf(child).nextSibling)
+			{
+				function(child);
+			}
+		}
+		
+		/// Appends all direct and indirect children of an entity to a list, parents before their children
+		/// \param id of the entity
+		/// \param descendants list to append to
+		template<typename TAllocator>
+		void CollectDescendants(EntityId id, std::vector<EntityId, TAllocator> &descendants) const FLUFF_MAYBE_NOEXCEPT
+		{
+			std::size_t next = descendants.size();
+			ForeachChild(id, [&descendants](EntityId child) { descendants.push_back(child); });
+			for (; next < descendants.size(); ++next)
+			{
+				ForeachChild(descendants[next], [&descendants](EntityId child) { descendants.push_back(child); });
+			}
+		}
+		
+		/// Calls function for every entity with a parent, sorted by depth. Every parent is visited before its children,
+		/// so values can be propagated from the roots to the leaves in a single linear pass
+		/// \param function callable with signature void(EntityId child, EntityId parent)
+		template<typename TFunc>
+		void ForeachInDepthOrder(TFunc &&function) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, EntityId, EntityId>)
+		{
+			SortByDepth();
+			
+			// roots are at the front, they do not have a parent to propagate from
+			auto current = std::partition_point(_nodes.cbegin(), _nodes.cend(), [](const Node &node) { return node.depth == 0; });
+			for (; current != _nodes.cend(); ++current)
+			{
+				function(current->id, current->parent);
+			}
+		}
+	
+		
+		/// Sorts the nodes by depth, if they changed since the last sort
+		/// \return all nodes, roots first and every parent before its children
+		[[nodiscard]] const std::pmr::vector<Node> &GetNodesInDepthOrder() FLUFF_MAYBE_NOEXCEPT
+		{
+			SortByDepth();
+			return _nodes;
+		}
+	
+	private:
+		[[nodiscard]] inline Node &NodeOf(EntityId id) FLUFF_NOEXCEPT
+		{
+			return _nodes[_sparse[id]];
+		}
+		
+		[[nodiscard]] inline const Node &NodeOf(EntityId id) const FLUFF_NOEXCEPT
+		{
+			return _nodes[_sparse[id]];
+		}
+		
+		void AddNode(EntityId id) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (Contains(id))
+			{
+				return;
+			}
+			
+			if (not _nodes.empty() && _nodes.back().depth != 0)
+			{
+				_isSorted = false;
+			}
+			_sparse.AddEntry(id, _nodes.size());
+			_nodes.emplace_back().id = id;
+		}
+		
+		/// Detaches a node from its parent and siblings, keeping its children
+		void Unlink(EntityId id) FLUFF_NOEXCEPT
+		{
+			Node &node = NodeOf(id);
+			if (node.parent == NO_ENTITY)
+			{
+				return;
+			}
+			
+			if (node.previousSibling != NO_ENTITY)
+			{
+				NodeOf(node.previousSibling).nextSibling = node.nextSibling;
+			} else
+			{
+				NodeOf(node.parent).firstChild = node.nextSibling;
+			}
+			if (node.nextSibling != NO_ENTITY)
+			{
+				NodeOf(node.nextSibling).previousSibling = node.previousSibling;
+			}
+			
+			node.parent = NO_ENTITY;
+			node.nextSibling = NO_ENTITY;
+			node.previousSibling = NO_ENTITY;
+		}
+		
+		/// Sets the depth of a node and updates the depths of all its descendants. The subtree is walked along the child,
+		/// sibling and parent links, so deep hierarchies need neither recursion nor a stack
+		void UpdateDepths(EntityId id, IndexType depth) FLUFF_NOEXCEPT
+		{
+			NodeOf(id).depth = depth;
+			_isSorted = false;
+			
+			EntityId current = NodeOf(id).firstChild;
+			while (current != NO_ENTITY)
+			{
+				Node &node = NodeOf(current);
+				node.depth = NodeOf(node.parent).depth + 1;
+				if (node.firstChild != NO_ENTITY)
+				{
+					current = node.firstChild;
+					continue;
+				}
+				
+				// go up until a node that has a next sibling, without leaving the subtree
+				while (current != id && NodeOf(current).nextSibling == NO_ENTITY)
+				{
+					current = NodeOf(current).parent;
+				}
+				current = current != id ? NodeOf(current).nextSibling : NO_ENTITY;
+			}
+		}
+		
+		/// Removes a node that has neither a parent nor children anymore
+		void RemoveIfUnused(EntityId id) FLUFF_NOEXCEPT
+		{
+			const IndexType index = _sparse[id];
+			const Node &node = _nodes[index];
+			if (node.parent != NO_ENTITY || node.firstChild != NO_ENTITY)
+			{
+				return;
+			}
+			
+			// swap with last node
+			if (index != _nodes.size() - 1)
+			{
+				_nodes[index] = _nodes.back();
+				_sparse.SetEntry(_nodes[index].id, index);
+				_isSorted = false;
+			}
+			_nodes.pop_back();
+			_sparse.MarkAsDeleted(id);
+		}
+		
+		void SortByDepth() FLUFF_MAYBE_NOEXCEPT
+		{
+			if (_isSorted)
+			{
+				return;
+			}
+			
+			std::stable_sort(_nodes.begin(), _nodes.end(), [](const Node &lhs, const Node &rhs) { return lhs.depth < rhs.depth; });
+			for (IndexType i = 0; i < _nodes.size(); ++i)
+			{
+				_sparse.SetEntry(_nodes[i].id, i);
+			}
+			for (Node &node : _nodes)
+			{
+				if (node.parent != NO_ENTITY)
+				{
+					node.parentIndex = _sparse[node.parent];
+				}
+			}
+			_isSorted = true;
+		}
+	
+	private:
+		std::pmr::vector<Node> _nodes;
+		
+		/// maps from EntityId to the index in _nodes
+		PagedSparseSet<IndexType, EntityId> _sparse;
+		
+		/// whether _nodes is sorted by depth
+		bool _isSorted = true;
+	};
+}
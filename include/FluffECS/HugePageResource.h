@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <memory_resource>
+#include <unordered_map>
+#include "Keywords.h"
+
+#if defined __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace flf
+{
+	/// Describes on which NUMA node the memory of large allocations is placed
+	enum class NumaPlacement
+	{
+		/// leaves the placement to the operating system, usually the node of the thread that first touches the memory
+		Default,
+		/// places the memory on HugePageOptions::numaNode
+		FixedNode,
+		/// places the memory on the node of the thread that allocates it, e.g. the worker thread that grows a chunk
+		CallerNode
+	};
+	
+	/// Options of a HugePageResource
+	struct HugePageOptions
+	{
+		/// allocations of at least this many bytes are mapped directly, smaller ones are taken from the pool
+		std::size_t largeAllocationThreshold = 2 * 1024 * 1024;
+		/// tries explicit huge pages (MAP_HUGETLB) first. They need to be reserved by the system administrator,
+		/// otherwise transparent huge pages are requested instead
+		bool useExplicitHugePages = true;
+		NumaPlacement numaPlacement = NumaPlacement::Default;
+		/// the node used with NumaPlacement::FixedNode
+		int numaNode = 0;
+		/// when true, allocations fail instead of falling back to other nodes once the node is full
+		bool strictNumaBinding = false;
+	};
+	
+	/// A memory resource for worlds with large amounts of component data. Large allocations, e.g. the vectors of big
+	/// Archetypes, are mapped directly from the operating system, backed by huge pages to reduce TLB misses during
+	/// iteration, and can be placed on a NUMA node. Smaller allocations are served by an unsynchronized pool. Large
+	/// allocations are rounded up to a multiple of HUGE_PAGE_SIZE. On systems other than Linux all allocations use the pool.
+	/// Use BasicWorld<HugePageResource> to use it for all components of a world; to change the options, derive from it with
+	/// a constructor taking std::pmr::pool_options. World.h does not include this header, as it pulls in system headers
+	/// that most worlds do not need, so include it where it is used
+	class HugePageResource :
+			public std::pmr::memory_resource
+	{
+	public:
+		static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+		
+		HugePageResource() FLUFF_NOEXCEPT = default;
+		
+		/// \param poolOptions of the pool used for small allocations
+		explicit HugePageResource(const std::pmr::pool_options &poolOptions) FLUFF_NOEXCEPT: _pool(poolOptions)
+		{
+		}
+		
+		/// \param options for large allocations
+		/// \param poolOptions of the pool used for small allocations
+		explicit HugePageResource(const HugePageOptions &options, const std::pmr::pool_options &poolOptions = {}) FLUFF_NOEXCEPT
+				: _options(options), _pool(poolOptions)
+		{
+		}
+		
+		HugePageResource(const HugePageResource &) = delete;
+		
+		HugePageResource &operator=(const HugePageResource &) = delete;
+		
+		/// Unmaps all large allocations that were not freed, like the pool releases all of its memory
+		~HugePageResource() override
+		{
+#if defined __linux__
+			for (const auto &[memory, mappedBytes] : _mappings)
+			{
+				munmap(memory, mappedBytes);
+			}
+#endif
+		}
+		
+		[[nodiscard]] inline const HugePageOptions &GetOptions() const FLUFF_NOEXCEPT
+		{
+			return _options;
+		}
+		
+		/// \return the number of bytes currently mapped for large allocations, including the rounding to huge pages
+		[[nodiscard]] inline std::size_t GetMappedBytes() const FLUFF_NOEXCEPT
+		{
+			return _mappedBytes;
+		}
+		
+		/// \return the NUMA node the calling thread runs on, or -1 if it is unknown
+		[[nodiscard]] static int CurrentNumaNode() FLUFF_NOEXCEPT
+		{
+#if defined __linux__ && defined SYS_getcpu
+			unsigned int cpu = 0;
+			unsigned int node = 0;
+			if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+			{
+				return static_cast<int>(node);
+			}
+#endif
+			return -1;
+		}
+	
+	protected:
+		void *do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+#if defined __linux__
+			if (bytes >= _options.largeAllocationThreshold && alignment <= HUGE_PAGE_SIZE)
+			{
+				return MapLarge(bytes);
+			}
+#endif
+			return _pool.allocate(bytes, alignment);
+		}
+		
+		void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+		{
+			if (p == nullptr)
+			{
+				return;
+			}
+#if defined __linux__
+			if (bytes >= _options.largeAllocationThreshold && alignment <= HUGE_PAGE_SIZE)
+			{
+				const auto mapping = _mappings.find(p);
+				assert(mapping != _mappings.end() && "Memory was not allocated by this resource");
+				munmap(p, mapping->second);
+				_mappedBytes -= mapping->second;
+				_mappings.erase(mapping);
+				return;
+			}
+#endif
+			_pool.deallocate(p, bytes, alignment);
+		}
+		
+		[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const FLUFF_NOEXCEPT override
+		{
+			return this == &other;
+		}
+	
+	private:
+		[[nodiscard]] static constexpr std::size_t RoundToHugePages(std::size_t bytes) FLUFF_NOEXCEPT
+		{
+			return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		}
+
+#if defined __linux__
+		
+		/// Maps memory for a large allocation, aligned to HUGE_PAGE_SIZE
+		/// \param bytes to allocate
+		/// \return the mapped memory
+		void *MapLarge(std::size_t bytes)
+		{
+			const std::size_t mappedBytes = RoundToHugePages(bytes);
+			void *memory = MAP_FAILED;
+#if defined MAP_HUGETLB
+			if (_options.useExplicitHugePages)
+			{
+				memory = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			}
+#endif
+			if (memory == MAP_FAILED)
+			{
+				memory = MapAligned(mappedBytes);
+			}
+			
+			BindToNode(memory, mappedBytes);
+			_mappings.emplace(memory, mappedBytes);
+			_mappedBytes += mappedBytes;
+			return memory;
+		}
+		
+		/// Maps memory aligned to HUGE_PAGE_SIZE and asks for transparent huge pages
+		/// \param mappedBytes to map, a multiple of HUGE_PAGE_SIZE
+		/// \return the mapped memory
+		static void *MapAligned(std::size_t mappedBytes)
+		{
+			// map an extra huge page, so that an aligned range can be cut out
+			const std::size_t paddedBytes = mappedBytes + HUGE_PAGE_SIZE;
+			void *padded = mmap(nullptr, paddedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (padded == MAP_FAILED)
+			{
+				throw std::bad_alloc();
+			}
+			
+			auto *const begin = static_cast<std::byte *>(padded);
+			const auto address = reinterpret_cast<std::uintptr_t>(begin);
+			auto *const aligned = begin + ((HUGE_PAGE_SIZE - address % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE);
+			if (aligned != begin)
+			{
+				munmap(begin, aligned - begin);
+			}
+			if (std::byte *const end = aligned + mappedBytes; end != begin + paddedBytes)
+			{
+				munmap(end, begin + paddedBytes - end);
+			}
+
+#if defined MADV_HUGEPAGE
+			madvise(aligned, mappedBytes, MADV_HUGEPAGE);
+#endif
+			return aligned;
+		}
+		
+		/// Applies the NUMA placement of the options to mapped memory. Failures are ignored, e.g. on systems without NUMA
+		/// \param memory that was not touched yet
+		/// \param mappedBytes size of the memory
+		void BindToNode(void *memory, std::size_t mappedBytes) const FLUFF_NOEXCEPT
+		{
+#if defined SYS_mbind
+			int node = -1;
+			if (_options.numaPlacement == NumaPlacement::FixedNode)
+			{
+				node = _options.numaNode;
+			} else if (_options.numaPlacement == NumaPlacement::CallerNode)
+			{
+				node = CurrentNumaNode();
+			}
+			
+			constexpr int N_MASK_BITS = 8 * sizeof(unsigned long);
+			if (node < 0 || node >= N_MASK_BITS)
+			{
+				return;
+			}
+			
+			// values of MPOL_PREFERRED and MPOL_BIND from <linux/mempolicy.h>, which is not available everywhere
+			const int mode = _options.strictNumaBinding ? 2 : 1;
+			const unsigned long nodeMask = 1ul << node;
+			syscall(SYS_mbind, memory, mappedBytes, mode, &nodeMask, N_MASK_BITS, 0u);
+#else
+			static_cast<void>(memory);
+			static_cast<void>(mappedBytes);
+#endif
+		}
+
+#endif
+	
+	private:
+		HugePageOptions _options{};
+		/// serves all allocations below the threshold
+		std::pmr::unsynchronized_pool_resource _pool{};
+		/// size of every live large allocation
+		std::unordered_map<void *, std::size_t> _mappings{};
+		std::size_t _mappedBytes = 0;
+	};
+}
@@ -79,7 +79,7 @@ namespace flf::internal
 					return _next.size() - 1;
 				}
 				
-				// binary search for the given key
+				// binary search for the first key that is larger than the given key
 				std::size_t startIndex = 0;
 				std::size_t endIndex = _next.size();
 				
@@ -87,27 +87,17 @@ namespace flf::internal
 				{
 					std::size_t midIndex = (startIndex + endIndex) / 2u;
 					
-					if (_next[midIndex].Key() == key)
+					if (_next[midIndex].Key() <= key)
 					{
-						return midIndex;
-					}
-					
-					if (_next[midIndex].Key() < key)
-					{
-						startIndex = midIndex;
+						startIndex = midIndex + 1;
 					} else
 					{
 						endIndex = midIndex;
 					}
 				}
 				
-				if (_next[endIndex].Key() <= key) FLUFF_LIKELY
-				{
-					return endIndex;
-				} else
-				{
-					return std::numeric_limits<std::size_t>::max();
-				}
+				// as the front key is lower or equal to key, startIndex is at least 1 here
+				return startIndex - 1;
 			}
 			
 			[[nodiscard]] inline Node *GetChild(TKey key)
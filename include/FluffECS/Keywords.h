@@ -14,6 +14,13 @@
 #define FLUFF_UNLIKELY
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+/// Hints the processor to load the cache line of an address, never faults
+#define FLUFF_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define FLUFF_PREFETCH(address) ((void) (address))
+#endif
+
 
 #include <type_traits>
 #include <cassert>
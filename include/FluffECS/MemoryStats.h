@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include "Keywords.h"
+#include "TypeId.h"
+
+namespace flf
+{
+	/// Memory of the components of a single type, either in one Archetype or summed up over a whole world
+	struct ColumnMemoryStats
+	{
+		IdType type = 0;
+		/// bytes of the components of existing entities
+		std::size_t usedBytes = 0;
+		/// bytes reserved for the components, including unused capacity and holes
+		std::size_t reservedBytes = 0;
+	};
+	
+	/// Memory of a single Archetype
+	struct ArchetypeMemoryStats
+	{
+		/// combined id of all types of the Archetype
+		MultiIdType signature = 0;
+		/// true for the storage of a group, whose entities are also counted in their Archetypes
+		bool isGroup = false;
+		std::size_t entityCount = 0;
+		/// number of rows in the vectors, including holes
+		std::size_t rowCount = 0;
+		/// number of rows that fit into the vectors without a reallocation
+		std::size_t capacity = 0;
+		/// number of types saved in the vectors of the Archetype itself
+		std::size_t columnCount = 0;
+		/// sum of the used bytes of all columns
+		std::size_t usedBytes = 0;
+		/// sum of the reserved bytes of all columns
+		std::size_t reservedBytes = 0;
+		/// bytes reserved for the entity ids and for the lookup from entity ids to rows
+		std::size_t idBytes = 0;
+	};
+	
+	/// Memory of a whole world
+	struct WorldMemoryStats
+	{
+		std::size_t entityCount = 0;
+		std::size_t archetypeCount = 0;
+		std::size_t groupCount = 0;
+		/// bytes of the components of existing entities, in Archetypes, groups and sparse storages
+		std::size_t usedBytes = 0;
+		/// bytes the world requested from its memory resources for components, including unused capacity
+		std::size_t reservedBytes = 0;
+		/// the largest value reservedBytes ever had
+		std::size_t peakReservedBytes = 0;
+		/// bytes reserved for the entity ids and lookups of all Archetypes, groups and sparse storages
+		std::size_t idBytes = 0;
+		/// bytes reserved for the lookup from entity ids to their Archetypes
+		std::size_t entityLookupBytes = 0;
+		
+		/// \return the fraction of the reserved component memory that is not used by any entity, between 0 and 1
+		[[nodiscard]] inline double Fragmentation() const FLUFF_NOEXCEPT
+		{
+			return reservedBytes == 0 ? 0.0 : 1.0 - static_cast<double>(usedBytes) / static_cast<double>(reservedBytes);
+		}
+	};
+}
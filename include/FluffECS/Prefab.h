@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include "Keywords.h"
+#include "TypeId.h"
+#include "VirtualConstructor.h"
+
+namespace flf
+{
+	class Archetype;
+	
+	/// Handle to a set of component values registered in a world. Instantiating a prefab creates entities with copies of these values
+	class Prefab
+	{
+	public:
+		constexpr explicit Prefab(std::size_t index) FLUFF_NOEXCEPT: _index(index)
+		{
+		}
+		
+		/// \return the index of the prefab in its world
+		[[nodiscard]] constexpr inline std::size_t Index() const FLUFF_NOEXCEPT
+		{
+			return _index;
+		}
+	
+	private:
+		std::size_t _index;
+	};
+	
+	namespace internal
+	{
+		/// Owns a single row of type erased component values, together with the Archetype that entities created from it belong to
+		class PrefabRow
+		{
+		public:
+			explicit PrefabRow(std::pmr::memory_resource &resource) FLUFF_NOEXCEPT
+					: _resource(&resource), _typeInfos(&resource), _constructors(&resource), _values(&resource)
+			{
+			}
+			
+			PrefabRow(const PrefabRow &) = delete;
+			
+			PrefabRow &operator=(const PrefabRow &) = delete;
+			
+			~PrefabRow() FLUFF_NOEXCEPT
+			{
+				for (std::size_t i = 0; i < _values.size(); ++i)
+				{
+					_constructors[i].destruct(_values[i]);
+					_resource->deallocate(_values[i], _typeInfos[i].size);
+				}
+			}
+			
+			/// Saves a copy of a value. Tags are skipped, they are only part of the signature of the Archetype
+			/// \param tInfo of the type of the value
+			/// \param constructors of the type of the value
+			/// \param value to copy
+			void Add(TypeInformation tInfo, ConstructorVTable constructors, const void *value) FLUFF_MAYBE_NOEXCEPT
+			{
+				assert(ValueOf(tInfo.id) == nullptr && "Type was already added");
+				assert(constructors.copyConstruct && "Prefab components have to be copy constructible");
+				if (constructors.isEmpty)
+				{
+					return;
+				}
+				
+				void *data = _resource->allocate(tInfo.size);
+				constructors.copyConstruct(data, const_cast<void *>(value));
+				_typeInfos.push_back(tInfo);
+				_constructors.push_back(constructors);
+				_values.push_back(data);
+			}
+			
+			/// Saves a value. Tags are skipped, they are only part of the signature of the Archetype
+			/// \param value to save
+			template<typename T>
+			void Add(T &&value) FLUFF_MAYBE_NOEXCEPT
+			{
+				using TValue = std::remove_cv_t<std::remove_reference_t<T>>;
+				if constexpr (not IsEmpty<TValue>)
+				{
+					assert(ValueOf(TypeId<TValue>()) == nullptr && "Type was already added");
+					void *data = _resource->allocate(sizeof(TValue));
+					new(data) TValue(std::forward<T>(value));
+					_typeInfos.push_back(TypeInformation::Of<TValue>());
+					_constructors.push_back(ConstructorVTable::Of<TValue>());
+					_values.push_back(data);
+				}
+			}
+			
+			/// \param type id of a type
+			/// \return a pointer to the saved value of the type, or nullptr if there is none
+			[[nodiscard]] const void *ValueOf(IdType type) const FLUFF_NOEXCEPT
+			{
+				for (std::size_t i = 0; i < _typeInfos.size(); ++i)
+				{
+					if (_typeInfos[i].id == type)
+					{
+						return _values[i];
+					}
+				}
+				return nullptr;
+			}
+			
+			/// \tparam T type of the value. Has to be saved in this row
+			/// \return a reference to the saved value
+			template<typename T>
+			[[nodiscard]] T &Get() FLUFF_NOEXCEPT
+			{
+				assert(ValueOf(TypeId<T>()) != nullptr && "Type is not part of the prefab");
+				return *std::launder(static_cast<T *>(const_cast<void *>(ValueOf(TypeId<T>()))));
+			}
+		
+		public:
+			/// the Archetype that instances of this row are created in
+			Archetype *archetype = nullptr;
+		
+		private:
+			std::pmr::memory_resource *_resource;
+			std::pmr::vector<TypeInformation> _typeInfos;
+			std::pmr::vector<ConstructorVTable> _constructors;
+			std::pmr::vector<void *> _values;
+		};
+	}
+}
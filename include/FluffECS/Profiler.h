@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "Keywords.h"
+
+/// may be defined to record the duration of every Foreach of a world and of every FLUFF_PROFILE_SCOPE.
+/// Without it, all profiling macros compile to nothing
+//#define FLUFF_PROFILE
+
+#define FLUFF_PROFILE_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define FLUFF_PROFILE_CONCAT(lhs, rhs) FLUFF_PROFILE_CONCAT_IMPL(lhs, rhs)
+
+#ifdef FLUFF_PROFILE
+/// Records the time until the end of the current scope as an event of a Profiler, e.g. for a whole system
+/// \param profiler to record into, e.g. world.GetProfiler()
+/// \param name of the event. Has to outlive the profiler, e.g. a string literal
+#define FLUFF_PROFILE_SCOPE(profiler, name) const ::flf::ProfileScope FLUFF_PROFILE_CONCAT(fluffProfileScope, __LINE__){(profiler), (name)}
+/// Counts an Archetype with the given number of entities for the innermost open event
+#define FLUFF_PROFILE_VISIT(profiler, nEntities) (profiler).Visit(nEntities)
+#else
+#define FLUFF_PROFILE_SCOPE(profiler, name) static_cast<void>(0)
+#define FLUFF_PROFILE_VISIT(profiler, nEntities) static_cast<void>(0)
+#endif
+
+namespace flf
+{
+	/// A timed section recorded by a Profiler
+	struct ProfileEvent
+	{
+		std::string_view name{};
+		/// nanoseconds since the creation of the profiler
+		std::uint64_t beginNs = 0;
+		std::uint64_t durationNs = 0;
+		std::size_t entitiesVisited = 0;
+		std::size_t archetypesVisited = 0;
+		/// Archetypes that matched, but contained no entities
+		std::size_t archetypesSkipped = 0;
+		/// number of events that were open when this one began
+		std::size_t depth = 0;
+	};
+	
+	/// Records timed and possibly nested events, e.g. of the iterations of a world. Not thread safe, like the world itself
+	class Profiler
+	{
+		using Clock = std::chrono::steady_clock;
+	
+	public:
+		/// Starts a new event, nested in the currently open ones
+		/// \param name of the event. Has to outlive the profiler, e.g. a string literal
+		void Begin(std::string_view name) FLUFF_MAYBE_NOEXCEPT
+		{
+			ProfileEvent &event = _events.emplace_back();
+			event.name = name;
+			event.depth = _open.size();
+			_open.push_back(_events.size() - 1);
+			event.beginNs = Now();
+		}
+		
+		/// Ends the innermost open event
+		void End() FLUFF_NOEXCEPT
+		{
+			assert(not _open.empty() && "No event was begun");
+			const std::uint64_t now = Now();
+			ProfileEvent &event = _events[_open.back()];
+			event.durationNs = now - event.beginNs;
+			_open.pop_back();
+		}
+		
+		/// Counts an Archetype for the innermost open event
+		/// \param nEntities number of entities of the Archetype. Empty Archetypes are counted as skipped
+		inline void Visit(std::size_t nEntities) FLUFF_NOEXCEPT
+		{
+			if (_open.empty())
+			{
+				return;
+			}
+			
+			ProfileEvent &event = _events[_open.back()];
+			if (nEntities == 0)
+			{
+				++event.archetypesSkipped;
+			} else
+			{
+				++event.archetypesVisited;
+				event.entitiesVisited += nEntities;
+			}
+		}
+		
+		/// \return all recorded events in the order they were begun
+		[[nodiscard]] inline const std::vector<ProfileEvent> &GetEvents() const FLUFF_NOEXCEPT
+		{
+			return _events;
+		}
+		
+		/// Removes all recorded events, e.g. at the start of every frame. Keeps their memory, so that recording the same
+		/// events every frame does not allocate. No event may be open
+		void Clear() FLUFF_NOEXCEPT
+		{
+			assert(_open.empty() && "Cannot clear while events are open");
+			_events.clear();
+		}
+		
+		/// Writes all completed events in the Chrome trace event format, which can be opened in chrome://tracing or Perfetto
+		/// \param out stream to write to
+		/// \param threadId shown for the events, e.g. to tell the profilers of multiple worlds apart
+		void WriteChromeTrace(std::ostream &out, int threadId = 0) const FLUFF_MAYBE_NOEXCEPT
+		{
+			out << "{\"traceEvents\":[";
+			bool first = true;
+			for (std::size_t i = 0; i < _events.size(); ++i)
+			{
+				if (std::find(_open.cbegin(), _open.cend(), i) != _open.cend())
+				{
+					continue;
+				}
+				
+				const ProfileEvent &event = _events[i];
+				out << (first ? "\n" : ",\n") << "{\"name\":\"";
+				WriteEscaped(out, event.name);
+				out << "\",\"cat\":\"flf\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadId
+				    << ",\"ts\":";
+				WriteMicroseconds(out, event.beginNs);
+				out << ",\"dur\":";
+				WriteMicroseconds(out, event.durationNs);
+				out << ",\"args\":{\"entities\":" << event.entitiesVisited << ",\"archetypes\":" << event.archetypesVisited
+				    << ",\"skipped\":" << event.archetypesSkipped << "}}";
+				first = false;
+			}
+			out << "\n]}\n";
+		}
+	
+	private:
+		[[nodiscard]] inline std::uint64_t Now() const FLUFF_NOEXCEPT
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _origin).count();
+		}
+		
+		/// Writes a string as the content of a JSON string
+		static void WriteEscaped(std::ostream &out, std::string_view str) FLUFF_MAYBE_NOEXCEPT
+		{
+			for (const char c : str)
+			{
+				if (c == '"' || c == '\\')
+				{
+					out << '\\' << c;
+				} else if (static_cast<unsigned char>(c) < 0x20)
+				{
+					out << ' ';
+				} else
+				{
+					out << c;
+				}
+			}
+		}
+		
+		/// Writes nanoseconds as the microseconds used by the trace format, keeping the full precision
+		static void WriteMicroseconds(std::ostream &out, std::uint64_t ns) FLUFF_MAYBE_NOEXCEPT
+		{
+			const auto fraction = static_cast<unsigned int>(ns % 1000);
+			out << ns / 1000 << '.' << static_cast<char>('0' + fraction / 100) << static_cast<char>('0' + fraction / 10 % 10)
+			    << static_cast<char>('0' + fraction % 10);
+		}
+	
+	private:
+		Clock::time_point _origin = Clock::now();
+		std::vector<ProfileEvent> _events{};
+		/// indices of the events that were begun, but not ended yet
+		std::vector<std::size_t> _open{};
+	};
+	
+	/// Records an event of a Profiler from its construction until its destruction
+	class ProfileScope
+	{
+	public:
+		/// \param profiler to record into
+		/// \param name of the event. Has to outlive the profiler, e.g. a string literal
+		ProfileScope(Profiler &profiler, std::string_view name) FLUFF_MAYBE_NOEXCEPT: _profiler(profiler)
+		{
+			_profiler.Begin(name);
+		}
+		
+		ProfileScope(const ProfileScope &) = delete;
+		
+		ProfileScope &operator=(const ProfileScope &) = delete;
+		
+		~ProfileScope() FLUFF_NOEXCEPT
+		{
+			_profiler.End();
+		}
+	
+	private:
+		Profiler &_profiler;
+	};
+}
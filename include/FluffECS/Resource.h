@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+#include "Keywords.h"
+#include "TypeList.h"
+
+namespace flf
+{
+	/// Gives access to a resource of the world. A callable given to Foreach may declare parameters of type Res<T> or Res<const T>,
+	/// they are looked up once per call instead of once per entity
+	/// \tparam T type of the resource
+	template<typename T>
+	class Res
+	{
+	public:
+		constexpr explicit Res(T &resource) FLUFF_NOEXCEPT: _resource(&resource)
+		{
+		}
+	
+	public:
+		[[nodiscard]] constexpr inline T &Get() const FLUFF_NOEXCEPT
+		{
+			return *_resource;
+		}
+		
+		[[nodiscard]] constexpr inline T &operator*() const FLUFF_NOEXCEPT
+		{
+			return *_resource;
+		}
+		
+		[[nodiscard]] constexpr inline T *operator->() const FLUFF_NOEXCEPT
+		{
+			return _resource;
+		}
+	
+	private:
+		T *_resource;
+	};
+	
+	namespace internal
+	{
+		template<typename T>
+		constexpr bool IsResImpl = false;
+		
+		template<typename T>
+		constexpr bool IsResImpl<Res<T>> = true;
+		
+		/// true when T is a (possibly const or reference qualified) Res
+		template<typename T>
+		constexpr bool IsRes = IsResImpl<std::remove_cv_t<std::remove_reference_t<T>>>;
+		
+		/// \return true when any of the types is a Res
+		template<typename ...Ts>
+		constexpr bool ContainsRes(TypeList<Ts...>)
+		{
+			return (IsRes<Ts> || ...);
+		}
+		
+		/// \return a TypeList of all types that are not a Res
+		template<typename ...Ts>
+		constexpr auto RemoveResources(TypeList<Ts...>)
+		{
+			return (std::conditional_t<IsRes<Ts>, TypeList<>, TypeList<Ts>>() | ... | TypeList<>());
+		}
+		
+		/// \return a TypeList of all Res types, without qualifiers
+		template<typename ...Ts>
+		constexpr auto OnlyResources(TypeList<Ts...>)
+		{
+			return (std::conditional_t<IsRes<Ts>, TypeList<std::remove_cv_t<std::remove_reference_t<Ts>>>, TypeList<>>() | ... | TypeList<>());
+		}
+		
+		/// Splits a list into the Res types and all others
+		/// \return for every type its index in the list of Res types or in the list of other types, depending on what it is
+		template<typename ...Ts>
+		constexpr std::array<std::size_t, sizeof...(Ts)> ResourcePartitionIndices()
+		{
+			constexpr std::array<bool, sizeof...(Ts)> isRes{IsRes<Ts>...};
+			std::array<std::size_t, sizeof...(Ts)> indices{};
+			std::size_t nResources = 0;
+			std::size_t nOthers = 0;
+			for (std::size_t i = 0; i < sizeof...(Ts); ++i)
+			{
+				indices[i] = isRes[i] ? nResources++ : nOthers++;
+			}
+			return indices;
+		}
+		
+		/// \return a new index for every call, starting at 0
+		inline std::size_t NextResourceIndex() FLUFF_NOEXCEPT
+		{
+			static std::atomic<std::size_t> nextIndex{0};
+			return nextIndex++;
+		}
+		
+		/// Resources are saved in a dense table, each type gets its own slot
+		/// \tparam T type of the resource
+		/// \return the index of T in the resource table
+		template<typename T>
+		std::size_t ResourceIndex() FLUFF_NOEXCEPT
+		{
+			static const std::size_t index = NextResourceIndex();
+			return index;
+		}
+	}
+}
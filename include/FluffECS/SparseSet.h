@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <vector>
 #include <memory_resource>
+#include <limits>
+#include <algorithm>
 #include "Keywords.h"
 
 namespace flf::internal
@@ -48,23 +50,163 @@ namespace flf::internal
 			return _sparse[index];
 		}
 		
+		/// Starts loading the entry of an index into the cache, so that reading it later does not stall
+		/// \param index of an entry
+		inline void Prefetch(TIndex index) const FLUFF_NOEXCEPT
+		{
+			FLUFF_PREFETCH(_sparse.data() + index);
+		}
+		
 		inline void Reserve(TIndex size) FLUFF_MAYBE_NOEXCEPT
 		{
+			const std::size_t previousCapacity = _sparse.capacity();
 			_sparse.reserve(size);
+			CountResize(previousCapacity);
+		}
+		
+		/// \return the number of bytes reserved for the entries
+		[[nodiscard]] inline std::size_t ByteCapacity() const FLUFF_NOEXCEPT
+		{
+			return _sparse.capacity() * sizeof(T);
+		}
+		
+		/// Counts every reallocation of the entries in the given counter from now on
+		/// \param counter to increment, may be nullptr
+		inline void SetResizeCounter(std::size_t *counter) FLUFF_NOEXCEPT
+		{
+			_resizeCounter = counter;
 		}
 		
+		/// Grows the set, so that it can hold entries for all indices below size. Never removes entries
+		/// \param size number of indices
 		inline void Resize(TIndex size) FLUFF_MAYBE_NOEXCEPT
 		{
 			const TIndex previousSize = _sparse.size();
-			_sparse.resize(size);
+			if (size <= previousSize)
+			{
+				return;
+			}
 			
-			for (TIndex i = previousSize; i < size; ++i)
+			const std::size_t previousCapacity = _sparse.capacity();
+			_sparse.resize(size, std::numeric_limits<T>::max());
+			CountResize(previousCapacity);
+		}
+	
+	private:
+		/// \param previousCapacity of the entries before a possible reallocation
+		inline void CountResize(std::size_t previousCapacity) const FLUFF_NOEXCEPT
+		{
+			if (_resizeCounter != nullptr && _sparse.capacity() != previousCapacity)
 			{
-				_sparse[i] = std::numeric_limits<T>::max();
+				++*_resizeCounter;
 			}
 		}
 	
 	private:
 		std::pmr::vector<T> _sparse;
+		/// incremented whenever the entries are reallocated. May be nullptr
+		std::size_t *_resizeCounter = nullptr;
+	};
+	
+	/// A SparseSet that allocates its entries in fixed size pages. Only pages that contain at least one entry are allocated,
+	/// so a few scattered but large indices do not require memory for all indices below them
+	template<typename T, typename TIndex = std::size_t, TIndex PAGE_SIZE = 4096>
+	class PagedSparseSet
+	{
+	public:
+		explicit PagedSparseSet(std::pmr::memory_resource &sparseResource) FLUFF_NOEXCEPT
+				: _pages(&sparseResource)
+		{
+		}
+		
+		PagedSparseSet(const PagedSparseSet &) = delete;
+		
+		PagedSparseSet &operator=(const PagedSparseSet &) = delete;
+		
+		~PagedSparseSet() FLUFF_NOEXCEPT
+		{
+			for (T *page : _pages)
+			{
+				if (page != nullptr)
+				{
+					_pages.get_allocator().resource()->deallocate(page, PAGE_SIZE * sizeof(T), alignof(T));
+				}
+			}
+		}
+		
+		inline void AddEntry(TIndex index, T val) FLUFF_MAYBE_NOEXCEPT
+		{
+			GetOrCreatePage(index / PAGE_SIZE)[index % PAGE_SIZE] = val;
+		}
+		
+		inline void SetEntry(TIndex index, T val) FLUFF_NOEXCEPT
+		{
+			_pages[index / PAGE_SIZE][index % PAGE_SIZE] = val;
+		}
+		
+		inline void MarkAsDeleted(TIndex index) FLUFF_NOEXCEPT
+		{
+			_pages[index / PAGE_SIZE][index % PAGE_SIZE] = std::numeric_limits<T>::max();
+		}
+		
+		[[nodiscard]] inline bool Contains(TIndex index) const FLUFF_NOEXCEPT
+		{
+			const TIndex pageIndex = index / PAGE_SIZE;
+			return pageIndex < _pages.size() && _pages[pageIndex] != nullptr && _pages[pageIndex][index % PAGE_SIZE] != std::numeric_limits<T>::max();
+		}
+		
+		[[nodiscard]] inline T operator[](TIndex index) const FLUFF_NOEXCEPT
+		{
+			return _pages[index / PAGE_SIZE][index % PAGE_SIZE];
+		}
+		
+		/// \return the number of bytes reserved for the allocated pages and the page table
+		[[nodiscard]] inline std::size_t ByteCapacity() const FLUFF_NOEXCEPT
+		{
+			return _nPages * PAGE_SIZE * sizeof(T) + _pages.capacity() * sizeof(T *);
+		}
+		
+		/// Counts every new page and every reallocation of the page table in the given counter from now on
+		/// \param counter to increment, may be nullptr
+		inline void SetResizeCounter(std::size_t *counter) FLUFF_NOEXCEPT
+		{
+			_resizeCounter = counter;
+		}
+	
+	private:
+		T *GetOrCreatePage(TIndex pageIndex) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (pageIndex >= _pages.size())
+			{
+				const std::size_t previousCapacity = _pages.capacity();
+				_pages.resize(pageIndex + 1, nullptr);
+				CountResize(_pages.capacity() != previousCapacity);
+			}
+			
+			T *&page = _pages[pageIndex];
+			if (page == nullptr) FLUFF_UNLIKELY
+			{
+				page = static_cast<T *>(_pages.get_allocator().resource()->allocate(PAGE_SIZE * sizeof(T), alignof(T)));
+				std::fill(page, page + PAGE_SIZE, std::numeric_limits<T>::max());
+				++_nPages;
+				CountResize(true);
+			}
+			return page;
+		}
+		
+		inline void CountResize(bool resized) const FLUFF_NOEXCEPT
+		{
+			if (resized && _resizeCounter != nullptr)
+			{
+				++*_resizeCounter;
+			}
+		}
+	
+	private:
+		std::pmr::vector<T *> _pages;
+		/// number of allocated pages
+		std::size_t _nPages = 0;
+		/// incremented whenever a page is allocated or the page table is reallocated. May be nullptr
+		std::size_t *_resizeCounter = nullptr;
 	};
 }
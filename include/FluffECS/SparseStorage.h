@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include <memory_resource>
+#include <type_traits>
+#include <memory>
+#include "Keywords.h"
+#include "TypeId.h"
+#include "Entity.h"
+#include "DynamicVector.h"
+#include "SparseSet.h"
+#include "VirtualConstructor.h"
+#include "MemoryStats.h"
+
+namespace flf::internal
+{
+	/// Saves the components of a single type outside of any Archetype. Adding and removing a component only touches this
+	/// storage, the other components of the entity stay where they are
+	class SparseStorage
+	{
+	public:
+		using IndexType = std::size_t;
+		
+		/// \param tInfo of the saved component type
+		/// \param constructors of the saved component type
+		/// \param componentResource used for the component data and their ids
+		/// \param sparseResource used for the id lookup
+		SparseStorage(TypeInformation tInfo, ConstructorVTable constructors, std::pmr::memory_resource &componentResource,
+		              std::pmr::memory_resource &sparseResource) FLUFF_NOEXCEPT
+				: _typeInfo(tInfo), _constructors(constructors), _data(componentResource), _ids(&componentResource), _sparse(sparseResource)
+		{
+		}
+		
+		SparseStorage(const SparseStorage &) = delete;
+		
+		SparseStorage &operator=(const SparseStorage &) = delete;
+		
+		~SparseStorage() FLUFF_NOEXCEPT
+		{
+			Clear();
+			_data.Release();
+		}
+		
+		/// \param id of the entity
+		/// \return true when the entity has a component in this storage
+		[[nodiscard]] inline bool Contains(EntityId id) const FLUFF_NOEXCEPT
+		{
+			return _sparse.Contains(id);
+		}
+		
+		/// Adds a component to an entity. If the entity already has one, it is replaced
+		/// \tparam T type of this storage
+		/// \param id of the entity
+		/// \param args to construct the component with
+		/// \return a reference to the component
+		template<typename T, typename ...TArgs>
+		T &Emplace(EntityId id, TArgs &&...args) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(TypeId<T>() == _typeInfo.id && "Type does not match the storage");
+			if (Contains(id))
+			{
+				T *component = &Get<T>(id);
+				std::destroy_at(component);
+				return *new(component) T(std::forward<TArgs>(args)...);
+			}
+			
+			_sparse.AddEntry(id, _ids.size());
+			_ids.push_back(id);
+			return _data.template EmplaceBack<T>(std::forward<TArgs>(args)...);
+		}
+		
+		/// \tparam T type of this storage
+		/// \param id of an entity contained in this storage
+		/// \return a reference to the component of the entity
+		template<typename T>
+		[[nodiscard]] inline T &Get(EntityId id) FLUFF_NOEXCEPT
+		{
+			assert(Contains(id) && "Entity has no component in this storage");
+			return _data.template Get<T>(_sparse[id]);
+		}
+		
+		/// \tparam T type of this storage
+		/// \param id of an entity contained in this storage
+		/// \return a reference to the component of the entity
+		template<typename T>
+		[[nodiscard]] inline const T &Get(EntityId id) const FLUFF_NOEXCEPT
+		{
+			assert(Contains(id) && "Entity has no component in this storage");
+			return _data.template Get<T>(_sparse[id]);
+		}
+		
+		/// \param id of the entity
+		/// \return a pointer to the component of the entity, or nullptr if it has none
+		[[nodiscard]] inline void *GetRaw(EntityId id) FLUFF_NOEXCEPT
+		{
+			return Contains(id) ? _data.GetBytes(_sparse[id] * _typeInfo.size) : nullptr;
+		}
+		
+		/// Removes the component of an entity, does nothing if the entity has none
+		/// \param id of the entity
+		void Remove(EntityId id) FLUFF_NOEXCEPT
+		{
+			if (not Contains(id))
+			{
+				return;
+			}
+			
+			const IndexType index = _sparse[id];
+			const IndexType lastIndex = _ids.size() - 1;
+			void *removed = _data.GetBytes(index * _typeInfo.size);
+			if (not _constructors.isTriviallyDestructible)
+			{
+				_constructors.destruct(removed);
+			}
+			
+			if (index != lastIndex)
+			{
+				// swap with last element
+				void *last = _data.GetBytes(lastIndex * _typeInfo.size);
+				if (_constructors.isTriviallyCopyable)
+				{
+					std::memcpy(removed, last, _typeInfo.size);
+				} else
+				{
+					if (_constructors.moveConstruct != nullptr)
+					{
+						_constructors.moveConstruct(removed, last);
+					} else
+					{
+						_constructors.copyConstruct(removed, last);
+					}
+					_constructors.destruct(last);
+				}
+				
+				_ids[index] = _ids[lastIndex];
+				_sparse.SetEntry(_ids[index], index);
+			}
+			
+			_data.PopBackBytes(_typeInfo.size);
+			_ids.pop_back();
+			_sparse.MarkAsDeleted(id);
+		}
+		
+		/// Moves the component of an entity to the storage of the same type in another world
+		/// \param destination storage of the same type
+		/// \param id of an entity contained in this storage
+		/// \param newId of the entity in the world of the destination. May not have a component there yet
+		void MoveTo(SparseStorage &destination, EntityId id, EntityId newId) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(destination._typeInfo.id == _typeInfo.id && "Type does not match the storage");
+			assert(Contains(id) && not destination.Contains(newId));
+			
+			void *component = _data.GetBytes(_sparse[id] * _typeInfo.size);
+			if (_constructors.moveConstruct != nullptr)
+			{
+				destination._data.EmplaceBackUsing(component, _typeInfo.size, _constructors);
+			} else
+			{
+				destination._data.PushBackUsing(component, _typeInfo.size, _constructors);
+			}
+			destination._sparse.AddEntry(newId, destination._ids.size());
+			destination._ids.push_back(newId);
+			Remove(id);
+		}
+		
+		/// Removes all components in this storage
+		void Clear() FLUFF_NOEXCEPT
+		{
+			for (IndexType i = 0; i < _ids.size(); ++i)
+			{
+				if (not _constructors.isTriviallyDestructible)
+				{
+					_constructors.destruct(_data.GetBytes(i * _typeInfo.size));
+				}
+				_sparse.MarkAsDeleted(_ids[i]);
+			}
+			
+			_data.PopBackBytes(_data.ByteSize());
+			_ids.clear();
+		}
+		
+		/// Reduces the capacity of the component data and the ids to the number of components
+		void ShrinkToFit() FLUFF_MAYBE_NOEXCEPT
+		{
+			_data.ShrinkToFitUsing(_typeInfo.size, _constructors);
+			_ids.shrink_to_fit();
+		}
+		
+		/// Sets the growth policy and memory accounting of the component data
+		/// \param context of the owning world. May be nullptr
+		inline void SetVectorContext(VectorContext *context) FLUFF_NOEXCEPT
+		{
+			_data.SetContext(context);
+			_sparse.SetResizeCounter(context != nullptr ? &context->changes.sparseResizes : nullptr);
+		}
+		
+		/// \return number of components in this storage
+		[[nodiscard]] inline IndexType Size() const FLUFF_NOEXCEPT
+		{
+			return _ids.size();
+		}
+		
+		/// \return the ids of all entities with a component in this storage, in the same order as the component data
+		[[nodiscard]] inline const std::pmr::vector<EntityId> &GetIds() const FLUFF_NOEXCEPT
+		{
+			return _ids;
+		}
+		
+		/// \return the memory of the component data
+		[[nodiscard]] ColumnMemoryStats GetColumnMemory() const FLUFF_NOEXCEPT
+		{
+			return {_typeInfo.id, _data.ByteSize(), _data.ByteCapacity()};
+		}
+		
+		/// \return the number of bytes reserved for the ids and the lookup from entity ids to components
+		[[nodiscard]] std::size_t IdByteCapacity() const FLUFF_NOEXCEPT
+		{
+			return _ids.capacity() * sizeof(EntityId) + _sparse.ByteCapacity();
+		}
+		
+		/// \return information about the saved component type
+		[[nodiscard]] inline const TypeInformation &GetTypeInfo() const FLUFF_NOEXCEPT
+		{
+			return _typeInfo;
+		}
+	
+	private:
+		TypeInformation _typeInfo;
+		ConstructorVTable _constructors;
+		
+		DynamicVector _data;
+		std::pmr::vector<EntityId> _ids;
+		PagedSparseSet<IndexType, EntityId> _sparse;
+	};
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Keywords.h"
+#include "TypeId.h"
+#include "TypeList.h"
+#include "World.h"
+
+namespace flf
+{
+	/// Runs the systems of a frame on multiple threads. Every system is split into chunks of rows that are run in parallel,
+	/// and a system starts as soon as all earlier systems it conflicts with are finished, instead of waiting for the
+	/// whole previous stage. Two systems conflict when one of them writes a component type the other one reads or writes;
+	/// parameters taken by non-const reference are written, all others are read. Systems that do not conflict run at the
+	/// same time. The systems may not change the world structurally, and the world may not be used otherwise while Run
+	/// is executing. Sparse components and resources cannot be used by scheduled systems
+	/// \tparam TMemResource memory resource of the world
+	template<typename TMemResource = std::pmr::unsynchronized_pool_resource>
+	class BasicSystemScheduler
+	{
+	public:
+		/// number of rows of an Archetype that are run as a single task
+		static constexpr std::size_t DEFAULT_CHUNK_SIZE = 4096;
+		
+		/// \param world to run the systems on. Has to outlive the scheduler
+		/// \param nWorkers threads that are started in addition to the thread calling Run
+		explicit BasicSystemScheduler(BasicWorld<TMemResource> &world,
+		                              std::size_t nWorkers = std::max(std::thread::hardware_concurrency(), 1u) - 1) FLUFF_MAYBE_NOEXCEPT
+				: _world(&world)
+		{
+			_workers.reserve(nWorkers);
+			for (std::size_t i = 0; i < nWorkers; ++i)
+			{
+				_workers.emplace_back([this]() { WorkerLoop(); });
+			}
+		}
+		
+		BasicSystemScheduler(const BasicSystemScheduler &) = delete;
+		
+		BasicSystemScheduler &operator=(const BasicSystemScheduler &) = delete;
+		
+		~BasicSystemScheduler() FLUFF_NOEXCEPT
+		{
+			{
+				const std::lock_guard<std::mutex> lock(_mutex);
+				_stopping = true;
+			}
+			_wakeUp.notify_all();
+			for (std::thread &worker : _workers)
+			{
+				worker.join();
+			}
+		}
+		
+		/// Adds a system that is called for every entity with the component types of its parameters, like World::Foreach.
+		/// The function is called from multiple threads at once, each time for different entities
+		/// \param function of the system
+		/// \param chunkSize maximum number of rows of an Archetype that are run as a single task
+		/// \return the index of the system
+		template<typename TFunc>
+		std::size_t AddSystem(TFunc &&function, std::size_t chunkSize = DEFAULT_CHUNK_SIZE) FLUFF_MAYBE_NOEXCEPT
+		{
+			return AddSystemImpl<false>(std::forward<TFunc>(function), chunkSize, decltype(internal::CallableArgList(function))());
+		}
+		
+		/// Adds a system that is called for every entity with the component types of its parameters, passing the id of the
+		/// entity first, like World::ForeachEntity. The function is called from multiple threads at once
+		/// \param function of the system
+		/// \param chunkSize maximum number of rows of an Archetype that are run as a single task
+		/// \return the index of the system
+		template<typename TFunc>
+		std::size_t AddEntitySystem(TFunc &&function, std::size_t chunkSize = DEFAULT_CHUNK_SIZE) FLUFF_MAYBE_NOEXCEPT
+		{
+			return AddSystemImpl<true>(std::forward<TFunc>(function), chunkSize,
+			                           decltype(internal::RemoveFirst(internal::CallableArgList(function)))());
+		}
+		
+		/// Runs all systems once and returns when all of them are finished. The calling thread works on the systems as well
+		void Run() FLUFF_MAYBE_NOEXCEPT
+		{
+			// the chunks are collected up front, as looking up the Archetypes may change the query caches of the world
+			for (SystemState &system : _systems)
+			{
+				system.chunks.clear();
+				system.collect(system.chunks);
+				system.remainingChunks.store(system.chunks.size(), std::memory_order_relaxed);
+				system.remainingDependencies.store(system.dependencies.size(), std::memory_order_relaxed);
+			}
+			
+			_remainingSystems.store(_systems.size(), std::memory_order_relaxed);
+			for (std::size_t i = 0; i < _systems.size(); ++i)
+			{
+				if (_systems[i].dependencies.empty())
+				{
+					Start(i);
+				}
+			}
+			
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (_remainingSystems.load(std::memory_order_acquire) != 0)
+			{
+				if (_tasks.empty())
+				{
+					_wakeUp.wait(lock);
+					continue;
+				}
+				
+				const Task task = _tasks.front();
+				_tasks.pop_front();
+				lock.unlock();
+				RunTask(task);
+				lock.lock();
+			}
+		}
+		
+		/// \return the number of added systems
+		[[nodiscard]] inline std::size_t SystemCount() const FLUFF_NOEXCEPT
+		{
+			return _systems.size();
+		}
+		
+		/// \param system index of a system
+		/// \return the indices of the earlier systems that need to be finished before the system starts
+		[[nodiscard]] inline const std::vector<std::size_t> &GetDependencies(std::size_t system) const FLUFF_NOEXCEPT
+		{
+			return _systems[system].dependencies;
+		}
+	
+	private:
+		/// A chunk of a system
+		struct Task
+		{
+			std::size_t system;
+			std::size_t chunk;
+		};
+		
+		struct SystemState
+		{
+			/// sorted ids of the component types the system only reads
+			std::vector<IdType> reads{};
+			/// sorted ids of the component types the system writes
+			std::vector<IdType> writes{};
+			/// earlier systems that need to be finished first
+			std::vector<std::size_t> dependencies{};
+			/// later systems that wait for this one
+			std::vector<std::size_t> dependents{};
+			
+			std::function<void(std::vector<internal::QueryChunk> &)> collect{};
+			std::function<void(const internal::QueryChunk &)> run{};
+			
+			/// chunks of the current frame, kept to reuse their memory
+			std::vector<internal::QueryChunk> chunks{};
+			std::atomic<std::size_t> remainingChunks{0};
+			std::atomic<std::size_t> remainingDependencies{0};
+		};
+		
+		template<bool WITH_ENTITY, typename TFunc, typename ...TArgs>
+		std::size_t AddSystemImpl(TFunc &&function, std::size_t chunkSize, internal::TypeList<TArgs...>) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(not internal::ContainsRes(internal::TypeList<TArgs...>()), "Scheduled systems cannot use resources");
+			static_assert(((not std::is_pointer_v<TArgs>) && ...), "Type cannot be a pointer");
+			assert(chunkSize != 0 && "Chunks need to contain at least one row");
+			
+			SystemState &system = _systems.emplace_back();
+			(AddAccess<TArgs>(system), ...);
+			std::sort(system.reads.begin(), system.reads.end());
+			std::sort(system.writes.begin(), system.writes.end());
+			
+			BasicWorld<TMemResource> *world = _world;
+			system.collect = [world, chunkSize](std::vector<internal::QueryChunk> &chunks)
+			{
+				world->template CollectChunks<WITH_ENTITY, TArgs...>(chunkSize, chunks);
+			};
+			system.run = [function = std::forward<TFunc>(function)](const internal::QueryChunk &chunk) mutable
+			{
+				BasicWorld<TMemResource>::template ForeachInChunk<WITH_ENTITY, TArgs...>(function, chunk);
+			};
+			
+			const std::size_t index = _systems.size() - 1;
+			for (std::size_t earlier = 0; earlier < index; ++earlier)
+			{
+				if (Conflicts(_systems[earlier], system))
+				{
+					system.dependencies.push_back(earlier);
+					_systems[earlier].dependents.push_back(index);
+				}
+			}
+			return index;
+		}
+		
+		/// Adds the component type of a parameter to the types the system reads or writes. Tags are never written
+		template<typename TArg>
+		static void AddAccess(SystemState &system) FLUFF_MAYBE_NOEXCEPT
+		{
+			constexpr bool isWritten = std::is_reference_v<TArg> && not std::is_const_v<std::remove_reference_t<TArg>> &&
+			                           not internal::IsEmpty<ValueType<TArg>>;
+			(isWritten ? system.writes : system.reads).push_back(TypeId<ValueType<TArg>>());
+		}
+		
+		/// \return true when one of the systems writes a type the other one reads or writes
+		[[nodiscard]] static bool Conflicts(const SystemState &earlier, const SystemState &later) FLUFF_NOEXCEPT
+		{
+			const auto intersects = [](const std::vector<IdType> &lhs, const std::vector<IdType> &rhs)
+			{
+				return std::any_of(lhs.cbegin(), lhs.cend(), [&rhs](IdType type) { return std::binary_search(rhs.cbegin(), rhs.cend(), type); });
+			};
+			return intersects(earlier.writes, later.reads) || intersects(earlier.writes, later.writes) || intersects(earlier.reads, later.writes);
+		}
+		
+		/// Queues all chunks of a system whose dependencies are finished
+		/// \param index of the system
+		void Start(std::size_t index) FLUFF_MAYBE_NOEXCEPT
+		{
+			SystemState &system = _systems[index];
+			if (system.chunks.empty())
+			{
+				Finish(index);
+				return;
+			}
+			
+			{
+				const std::lock_guard<std::mutex> lock(_mutex);
+				for (std::size_t chunk = 0; chunk < system.chunks.size(); ++chunk)
+				{
+					_tasks.push_back({index, chunk});
+				}
+			}
+			_wakeUp.notify_all();
+		}
+		
+		/// Starts all systems that only waited for a finished system
+		/// \param index of the finished system
+		void Finish(std::size_t index) FLUFF_MAYBE_NOEXCEPT
+		{
+			for (const std::size_t dependent : _systems[index].dependents)
+			{
+				if (_systems[dependent].remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					Start(dependent);
+				}
+			}
+			
+			if (_remainingSystems.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				// take the lock, so that Run cannot miss the notification between its check and its wait
+				const std::lock_guard<std::mutex> lock(_mutex);
+				_wakeUp.notify_all();
+			}
+		}
+		
+		void RunTask(const Task &task) FLUFF_MAYBE_NOEXCEPT
+		{
+			SystemState &system = _systems[task.system];
+			system.run(system.chunks[task.chunk]);
+			if (system.remainingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Finish(task.system);
+			}
+		}
+		
+		void WorkerLoop() FLUFF_MAYBE_NOEXCEPT
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (true)
+			{
+				_wakeUp.wait(lock, [this]() { return _stopping || not _tasks.empty(); });
+				if (_stopping)
+				{
+					return;
+				}
+				
+				const Task task = _tasks.front();
+				_tasks.pop_front();
+				lock.unlock();
+				RunTask(task);
+				lock.lock();
+			}
+		}
+	
+	private:
+		BasicWorld<TMemResource> *_world;
+		/// a deque, so that adding systems does not move the atomics of the existing ones
+		std::deque<SystemState> _systems{};
+		
+		std::mutex _mutex{};
+		std::condition_variable _wakeUp{};
+		/// chunks that are ready to run, guarded by _mutex
+		std::deque<Task> _tasks{};
+		std::atomic<std::size_t> _remainingSystems{0};
+		bool _stopping = false;
+		
+		std::vector<std::thread> _workers{};
+	};
+	
+	using SystemScheduler = BasicSystemScheduler<std::pmr::unsynchronized_pool_resource>;
+}
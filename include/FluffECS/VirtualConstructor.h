@@ -1,5 +1,7 @@
 #pragma once
 
+#include "TypeList.h"
+
 namespace flf::internal
 {
 	template<typename T>
@@ -62,7 +64,10 @@ namespace flf::internal
 			return {std::is_default_constructible_v<T> ? &DefaultConstructAt<T> : nullptr,
 			        std::is_move_constructible_v<T> ? &MoveConstructAt<T> : nullptr,
 			        std::is_copy_constructible_v<T> ? &CopyConstructAt<T> : nullptr,
-			        std::is_destructible_v<T> ? &DestructAt<T> : nullptr};
+			        std::is_destructible_v<T> ? &DestructAt<T> : nullptr,
+			        std::is_trivially_destructible_v<T>,
+			        std::is_trivially_copyable_v<T>,
+			        IsEmpty<T>};
 		}
 		
 		void (*defaultConstruct)(void *at);
@@ -72,5 +77,14 @@ namespace flf::internal
 		void (*copyConstruct)(void *at, void *from);
 		
 		void (*destruct)(void *at);
+		
+		/// when true calling destruct may be skipped entirely
+		bool isTriviallyDestructible;
+		
+		/// when true the type may be moved around using memcpy
+		bool isTriviallyCopyable;
+		
+		/// when true the type has no state and is only saved in the signature of an Archetype, without a vector
+		bool isEmpty;
 	};
 }
@@ -5,6 +5,12 @@
 #include <memory_resource>
 #include <algorithm>
 #include <unordered_map>
+#include <functional>
+#include <utility>
+#include <memory>
+#include <numeric>
+#include <string_view>
+#include <cstddef>
 
 #include "Keywords.h"
 #include "TypeId.h"
@@ -12,12 +18,35 @@
 #include "Entity.h"
 #include "TypeList.h"
 #include "Archetype.h"
+#include "Resource.h"
+#include "Prefab.h"
+#include "DynamicQuery.h"
+#include "MemoryStats.h"
+#include "ChangeStats.h"
+#include "EntityStage.h"
+#include "Profiler.h"
 
 namespace flf
 {
+	namespace internal
+	{
+		/// A range of rows of an Archetype, used to split an iteration over multiple threads
+		struct QueryChunk
+		{
+			Archetype *container = nullptr;
+			std::size_t beginRow = 0;
+			std::size_t endRow = 0;
+		};
+	}
+	
+	template<typename TMemResource>
+	class BasicWorldView;
+	
+	template<typename TMemResource>
+	class BasicSystemScheduler;
 	
 	/// A world contains many entities that may have differing types. Each entity is saved in a Archetype that has
-	/// exactly the specific component types of that entity.
+	/// exactly the specific component types of that entity. For concurrent reads, see BasicWorldView
 	/// \tparam TMemResource polymorphic memory resource (from std::pmr) used for general storage of components
 	template<typename TMemResource = std::pmr::unsynchronized_pool_resource>
 	class BasicWorld :
@@ -25,13 +54,44 @@ namespace flf
 	{
 		static_assert(std::is_base_of_v<std::pmr::memory_resource, TMemResource>,
 		              "Memory resource must inherit from std::pmr::memory_resource");
+		
+		friend class BasicWorldView<TMemResource>;
+		
+		friend class BasicSystemScheduler<TMemResource>;
 	
 	private:
 		/// standard array size is 4KB to most efficiently use caching effects
 		static constexpr std::size_t COMPONENT_VECTOR_BYTE_SIZE = 4096;
 		
+		/// number of ids GetMany resolves together, small enough that their lookups stay in the cache between the passes
+		static constexpr std::size_t GET_MANY_BATCH_SIZE = 64;
+		
 		template<typename Key, typename Value> using Map = std::unordered_map<Key, Value>;
 		
+		/// Memory of a single resource
+		struct ResourceSlot
+		{
+			void *data = nullptr;
+			std::size_t size = 0;
+			std::size_t alignment = 0;
+			void (*destruct)(void *at) = nullptr;
+		};
+		
+		/// All containers that contain at least a set of types
+		struct QueryCache
+		{
+			/// sorted ids of the types
+			std::vector<IdType> types;
+			std::vector<Archetype *> containers;
+		};
+		
+		/// Layout of a component type that can be used without knowing it at compile time
+		struct RuntimeComponent
+		{
+			TypeInformation tInfo;
+			internal::ConstructorVTable constructors;
+		};
+		
 		static constexpr std::pmr::pool_options STANDARD_POOL_OPTIONS = {8, COMPONENT_VECTOR_BYTE_SIZE};
 		
 		template<typename T, typename ...Ts>
@@ -48,6 +108,16 @@ namespace flf
 				// we only call the destructor, the freeing of memory happens through memory resources
 				container.second->~Archetype();
 			}
+			for (Archetype *group : _groups)
+			{
+				group->~Archetype();
+			}
+			// the sparse storages use memory resources of this world
+			_sparseStorages.clear();
+			for (ResourceSlot &slot : _worldResources)
+			{
+				DestroyResource(slot);
+			}
 		}
 	
 	public:
@@ -56,7 +126,15 @@ namespace flf
 		template<typename TFunc>
 		void Foreach(TFunc &&function) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
 		{
-			ForeachImpl(function, internal::CallableArgList(function));
+			FLUFF_PROFILE_SCOPE(_profiler, internal::GetTypeName<std::decay_t<TFunc>>());
+			using Arguments = decltype(internal::CallableArgList(function));
+			if constexpr (internal::ContainsRes(Arguments()))
+			{
+				ForeachWithResources<false>(function, Arguments(), std::make_index_sequence<Arguments::Size()>());
+			} else
+			{
+				ForeachImpl(function, Arguments());
+			}
 		}
 		
 		/// Iterates over all components of the given types.
@@ -64,7 +142,83 @@ namespace flf
 		template<typename TFunc>
 		void ForeachEntity(TFunc &&function) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
 		{
-			ForeachEntityImpl(function, internal::RemoveFirst(internal::CallableArgList(function)));
+			FLUFF_PROFILE_SCOPE(_profiler, internal::GetTypeName<std::decay_t<TFunc>>());
+			using Arguments = decltype(internal::RemoveFirst(internal::CallableArgList(function)));
+			if constexpr (internal::ContainsRes(Arguments()))
+			{
+				ForeachWithResources<true>(function, Arguments(), std::make_index_sequence<Arguments::Size()>());
+			} else
+			{
+				ForeachEntityImpl(function, Arguments());
+			}
+		}
+		
+		/*
+		 * Resources
+		 */
+		
+		/// Creates a resource of the world, replacing the previous one of the same type. Every world can hold a single
+		/// object of each resource type, independent of any entity
+		/// \tparam TResource type of the resource
+		/// \param args to construct the resource with
+		/// \return a reference to the created resource
+		template<typename TResource, typename ...TArgs>
+		TResource &SetResource(TArgs &&...args) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(std::is_same_v<std::decay_t<TResource>, TResource>, "Type cannot be reference or pointer");
+			static_assert(std::is_constructible_v<TResource, TArgs...>, "Invalid constructor arguments given");
+			
+			const std::size_t index = internal::ResourceIndex<TResource>();
+			if (index >= _worldResources.size())
+			{
+				_worldResources.resize(index + 1);
+			}
+			
+			ResourceSlot &slot = _worldResources[index];
+			DestroyResource(slot);
+			slot.data = _containerResource.allocate(sizeof(TResource), alignof(TResource));
+			slot.size = sizeof(TResource);
+			slot.alignment = alignof(TResource);
+			slot.destruct = &internal::DestructAt<TResource>;
+			return *new(slot.data) TResource(std::forward<TArgs>(args)...);
+		}
+		
+		/// \tparam TResource type of the resource
+		/// \return a reference to the resource. It has to be created with SetResource before
+		template<typename TResource>
+		[[nodiscard]] inline TResource &Resource() FLUFF_NOEXCEPT
+		{
+			assert(HasResource<TResource>() && "Resource was not set");
+			return *std::launder(static_cast<TResource *>(_worldResources[internal::ResourceIndex<TResource>()].data));
+		}
+		
+		/// \tparam TResource type of the resource
+		/// \return a reference to the resource. It has to be created with SetResource before
+		template<typename TResource>
+		[[nodiscard]] inline const TResource &Resource() const FLUFF_NOEXCEPT
+		{
+			assert(HasResource<TResource>() && "Resource was not set");
+			return *std::launder(static_cast<const TResource *>(_worldResources[internal::ResourceIndex<TResource>()].data));
+		}
+		
+		/// \tparam TResource type of the resource
+		/// \return true when the resource was set and not removed since
+		template<typename TResource>
+		[[nodiscard]] inline bool HasResource() const FLUFF_NOEXCEPT
+		{
+			const std::size_t index = internal::ResourceIndex<TResource>();
+			return index < _worldResources.size() && _worldResources[index].data != nullptr;
+		}
+		
+		/// Destroys a resource, does nothing if it does not exist
+		/// \tparam TResource type of the resource
+		template<typename TResource>
+		void RemoveResource() FLUFF_NOEXCEPT
+		{
+			if (HasResource<TResource>())
+			{
+				DestroyResource(_worldResources[internal::ResourceIndex<TResource>()]);
+			}
 		}
 		
 		/// Gets the component of a given entity
@@ -77,6 +231,10 @@ namespace flf
 			static_assert((std::is_same_v<std::decay_t<TComponent>, TComponent>), "Type cannot be reference or pointer");
 			assert(Contains(entity.Id()) && "Entity does not belong to this World");
 			
+			if (auto *storage = SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+			{
+				return storage->template Get<TComponent>(entity.Id());
+			}
 			return ContainerOf(entity.Id()).template Get<TComponent>(entity.Id());
 		}
 		
@@ -90,6 +248,10 @@ namespace flf
 			static_assert((std::is_same_v<std::decay_t<TComponent>, TComponent>), "Type cannot be reference or pointer");
 			assert(Contains(entity.Id()) && "Entity does not belong to this World");
 			
+			if (auto *storage = SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+			{
+				return storage->template Get<TComponent>(entity.Id());
+			}
 			return ContainerOf(entity.Id()).template Get<TComponent>(entity.Id());
 		}
 		
@@ -102,6 +264,10 @@ namespace flf
 			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
 			(AssertCanBeComponent<TComponents>(), ...);
 			
+			if ((SparseStorageOf(TypeId<TComponents>()) || ...)) FLUFF_UNLIKELY
+			{
+				return CreateEntityWithSparse(TComponents()...);
+			}
 			return CreateEntityImpl(internal::Sort(internal::TypeList<TComponents...>()));
 		}
 		
@@ -114,6 +280,10 @@ namespace flf
 			static_assert((!std::is_pointer_v<TComponents> && ...), "Type cannot be a pointer");
 			(AssertCanBeComponent<ValueType<TComponents>>(), ...);
 			
+			if ((SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...)) FLUFF_UNLIKELY
+			{
+				return CreateEntityWithSparse(ValueType<TComponents>(std::forward<TComponents>(args))...);
+			}
 			return CreateEntityImpl(internal::Sort(internal::TypeList<ValueType<TComponents>...>()), std::forward<TComponents>(args)...);
 		}
 		
@@ -125,8 +295,9 @@ namespace flf
 		{
 			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
 			(AssertCanBeComponent<TComponents>(), ...);
+			assert(not (SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...) && "Sparse components need to be added with AddComponent");
 			
-			_entityToContainer.Reserve(_nextFreeIndex + numEntities);
+			_entityToContainer.Reserve(PeekNextFreeIndex() + numEntities);
 			CreateMultipleImpl(internal::Sort(internal::TypeList<TComponents...>()), numEntities);
 		}
 		
@@ -139,8 +310,9 @@ namespace flf
 		{
 			static_assert((!std::is_pointer_v<TComponents> && ...), "Type cannot be a pointer");
 			(AssertCanBeComponent<ValueType<TComponents>>(), ...);
+			assert(not (SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...) && "Sparse components need to be added with AddComponent");
 			
-			_entityToContainer.Reserve(_nextFreeIndex + numEntities);
+			_entityToContainer.Reserve(PeekNextFreeIndex() + numEntities);
 			CreateMultipleWith(internal::Sort(internal::TypeList<ValueType<TComponents>...>()), numEntities, args...);
 		}
 		
@@ -152,12 +324,92 @@ namespace flf
 			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
 			(AssertCanBeComponent<TComponents>(), ...);
 			assert(Contains(prototype.Id()) && "Entity does not belong to a Archetype");
+			assert(not (SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...) && "Sparse components need to be added with AddComponent");
 			
-			_entityToContainer.Reserve(_nextFreeIndex + numEntities);
+			_entityToContainer.Reserve(PeekNextFreeIndex() + numEntities);
 			CreateMultipleWith(internal::Sort(internal::TypeList<TComponents...>()), numEntities,
 			                   std::forward<TComponents>(Get<TComponents>(prototype))...);
 		}
 		
+		/*
+		 * Prefabs
+		 */
+		
+		/// Registers a prefab holding copies of the given components. Its Archetype is looked up once, so instantiating
+		/// it only copies the saved values into the vectors
+		/// \param components the instances shall have a copy of. Sparse components are not supported
+		/// \return a handle to the prefab
+		template<typename ...TComponents>
+		Prefab CreatePrefab(TComponents &&...components) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert((!std::is_pointer_v<TComponents> && ...), "Type cannot be a pointer");
+			(AssertCanBeComponent<ValueType<TComponents>>(), ...);
+			assert(not (SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...) && "Sparse components cannot be part of a prefab");
+			
+			internal::PrefabRow &row = *_prefabs.emplace_back(std::make_unique<internal::PrefabRow>(_containerResource));
+			(row.Add(std::forward<TComponents>(components)), ...);
+			row.archetype = &GetComponentVectorOf(internal::Sort(internal::TypeList<ValueType<TComponents>...>()));
+			return Prefab(_prefabs.size() - 1);
+		}
+		
+		/// Registers a prefab holding copies of all components of an entity. Sparse components of the entity are not copied
+		/// \param prototype to copy the components from
+		/// \return a handle to the prefab
+		Prefab CreatePrefabFrom(Entity prototype) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(Contains(prototype.Id()) && "Entity does not belong to this World");
+			
+			Archetype &container = ContainerOf(prototype.Id());
+			std::pmr::vector<TypeInformation> tInfos{&_tempResource};
+			std::pmr::vector<internal::ConstructorVTable> constructors{&_tempResource};
+			container.GetSignature(tInfos, constructors);
+			
+			internal::PrefabRow &row = *_prefabs.emplace_back(std::make_unique<internal::PrefabRow>(_containerResource));
+			for (std::size_t i = 0; i < tInfos.size(); ++i)
+			{
+				row.Add(tInfos[i], constructors[i], container.GetRaw(tInfos[i].id, prototype.Id()));
+			}
+			row.archetype = &container;
+			return Prefab(_prefabs.size() - 1);
+		}
+		
+		/// Gives access to a saved value of a prefab. Changes only affect entities instantiated afterwards
+		/// \tparam TComponent type of the value. Has to be part of the prefab
+		/// \param prefab to get the value of
+		/// \return a reference to the saved value
+		template<typename TComponent>
+		[[nodiscard]] TComponent &PrefabValue(Prefab prefab) FLUFF_NOEXCEPT
+		{
+			assert(prefab.Index() < _prefabs.size() && "Prefab does not belong to this World");
+			return _prefabs[prefab.Index()]->template Get<TComponent>();
+		}
+		
+		/// Creates an entity with copies of the values of a prefab
+		/// \param prefab to instantiate
+		/// \return the created entity
+		Entity Instantiate(Prefab prefab) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(prefab.Index() < _prefabs.size() && "Prefab does not belong to this World");
+			
+			const EntityId id = PeekNextFreeIndex();
+			const internal::PrefabRow &row = *_prefabs[prefab.Index()];
+			row.archetype->Instantiate(row, 1);
+			return Entity(id, *this);
+		}
+		
+		/// Creates multiple entities with copies of the values of a prefab. Each vector is filled with a single bulk copy,
+		/// trivially copyable components are copied with memcpy
+		/// \param prefab to instantiate
+		/// \param numEntities to create
+		void Instantiate(Prefab prefab, EntityId numEntities) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(prefab.Index() < _prefabs.size() && "Prefab does not belong to this World");
+			
+			_entityToContainer.Reserve(PeekNextFreeIndex() + numEntities);
+			const internal::PrefabRow &row = *_prefabs[prefab.Index()];
+			row.archetype->Instantiate(row, numEntities);
+		}
+		
 		/// Adds one or more new components to a given entity
 		/// \tparam TComponents types to add
 		/// \param entity to add the component to
@@ -167,8 +419,13 @@ namespace flf
 			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
 			(AssertCanBeComponent<TComponents>(), ...);
 			
+			if ((SparseStorageOf(TypeId<TComponents>()) || ...)) FLUFF_UNLIKELY
+			{
+				(AddSingleComponent<TComponents>(entity, TComponents()), ...);
+				return;
+			}
 			Archetype &destination = AddComponentMoveImpl<TComponents...>(entity);
-			(destination.GetVector<TComponents>().template PushBack<TComponents>(), ...);
+			(destination.template EmplaceComponent<TComponents>(), ...);
 		}
 		
 		/// Adds one or more new components to a given entity
@@ -181,123 +438,1669 @@ namespace flf
 			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
 			(AssertCanBeComponent<TComponents>(), ...);
 			
-			Archetype &destination = AddComponentMoveImpl<TComponents...>(entity);
-			(destination.GetVector<TComponents>().template EmplaceBack<TComponents>(std::forward<TComponents>(comps)), ...);
+			if ((SparseStorageOf(TypeId<TComponents>()) || ...)) FLUFF_UNLIKELY
+			{
+				(AddSingleComponent<TComponents>(entity, std::forward<TComponents>(comps)), ...);
+				return;
+			}
+			Archetype &destination = AddComponentMoveImpl<TComponents...>(entity);
+			(destination.template EmplaceComponent<TComponents>(std::forward<TComponents>(comps)), ...);
+		}
+		
+		template<typename TComponentToRemove>
+		void RemoveComponent(Entity entity) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(std::is_same_v<std::decay_t<TComponentToRemove>, TComponentToRemove>, "Type cannot be reference or pointer");
+			AssertCanBeComponent<TComponentToRemove>();
+			
+			RemoveComponentOf(entity, TypeId<TComponentToRemove>());
+		}
+		
+		/*
+		 * Runtime components
+		 */
+		
+		/// Registers a component type that has no C++ type, e.g. one defined by a script. Its components can be used with
+		/// the type erased methods CreateEntityOf, GetRaw, AddComponentOf, RemoveComponentOf and ForeachColumns.
+		/// The id is the hash of the name, so it must not equal the name of a C++ component type
+		/// \param name unique name of the type
+		/// \param size of a single component in bytes. Types of size 0 are tags without any data
+		/// \param alignment of a single component. May not be larger than alignof(std::max_align_t)
+		/// \param constructors callbacks to default construct, move or copy construct and destruct a component
+		/// \return the id of the type
+		IdType RegisterComponent(std::string_view name, std::size_t size, std::size_t alignment, internal::ConstructorVTable constructors) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(alignment <= alignof(std::max_align_t) && "Over aligned components are not supported");
+			constructors.isEmpty = size == 0;
+			assert((constructors.isEmpty || (constructors.defaultConstruct && constructors.destruct &&
+			                                 (constructors.moveConstruct || constructors.copyConstruct))) && "Missing constructor callbacks");
+			
+			const IdType id = internal::HashString(name);
+			assert((_runtimeComponents.count(id) == 0 || _runtimeComponents.at(id).tInfo.size == size) && "Type was registered with a different layout");
+			_runtimeComponents.insert_or_assign(id, RuntimeComponent{TypeInformation(id, size), constructors});
+			return id;
+		}
+		
+		/// Registers a C++ component type, so it can be used together with runtime components in the type erased methods
+		/// \tparam TComponent type to register
+		/// \return the id of the type
+		template<typename TComponent>
+		IdType RegisterComponent() FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(std::is_same_v<std::decay_t<TComponent>, TComponent>, "Type cannot be reference or pointer");
+			AssertCanBeComponent<TComponent>();
+			
+			_runtimeComponents.insert_or_assign(TypeId<TComponent>(), RuntimeComponent{TypeInformation::Of<TComponent>(),
+			                                                                           internal::ConstructorVTable::Of<TComponent>()});
+			return TypeId<TComponent>();
+		}
+		
+		/// \param type id of a component type
+		/// \return true when the type can be used in the type erased methods
+		[[nodiscard]] bool IsRegistered(IdType type) const FLUFF_NOEXCEPT
+		{
+			return _runtimeComponents.count(type) != 0;
+		}
+		
+		/// Creates an entity with default constructed components of the given registered types
+		/// \param types ids of the registered types, each id may only be given once
+		/// \param count number of types
+		/// \return a new entity
+		Entity CreateEntityOf(const IdType *types, std::size_t count) FLUFF_MAYBE_NOEXCEPT
+		{
+			const EntityId id = PeekNextFreeIndex();
+			GetComponentVectorOf(types, count).CreateMultipleDefault(1);
+			return Entity(id, *this);
+		}
+		
+		/// Creates multiple entities with default constructed components of the given registered types
+		/// \param numEntities to create
+		/// \param types ids of the registered types, each id may only be given once
+		/// \param count number of types
+		void CreateMultipleOf(EntityId numEntities, const IdType *types, std::size_t count) FLUFF_MAYBE_NOEXCEPT
+		{
+			_entityToContainer.Reserve(PeekNextFreeIndex() + numEntities);
+			GetComponentVectorOf(types, count).CreateMultipleDefault(numEntities);
+		}
+		
+		/// Creates a stage to create entities on another thread. Each thread needs its own stage
+		/// \param resource to allocate the staged components from. Has to be thread safe, or used by a single thread only
+		/// \param idBlockSize number of ids the stage reserves at once
+		/// \return the stage, which may be kept and reused every frame
+		[[nodiscard]] EntityStage CreateStage(std::pmr::memory_resource &resource = *std::pmr::get_default_resource(),
+		                                      EntityId idBlockSize = EntityStage::DEFAULT_ID_BLOCK_SIZE) FLUFF_NOEXCEPT
+		{
+			return EntityStage(*this, resource, idBlockSize);
+		}
+		
+		/// Moves all entities of a stage into this world, with a single bulk append per column. Has to be called while no
+		/// other thread uses the world or the stage. The stage is empty afterwards and can be reused
+		/// \param stage created by CreateStage of this world
+		void Merge(EntityStage &stage) FLUFF_MAYBE_NOEXCEPT
+		{
+			for (internal::StagedArchetype &staged : stage.GetStagedArchetypes())
+			{
+				if (staged.ids.empty())
+				{
+					continue;
+				}
+				assert(std::none_of(staged.typeInfos.cbegin(), staged.typeInfos.cend(), [this](TypeInformation tInfo) { return SparseStorageOf(tInfo.id); }) &&
+				       "Sparse components cannot be staged");
+				
+				const auto found = _componentContainers.find(staged.signature);
+				Archetype &container = found != _componentContainers.end() ? *found->second
+				                                                           : CreateComponentContainerWith(staged.typeInfos, staged.constructors, staged.signature);
+				container.AppendColumns(staged.ids.data(), staged.ids.size(), staged.typeInfos.data(), staged.constructors.data(), staged.columns.data());
+				staged.ids.clear();
+			}
+		}
+		
+		/// Moves all entities of another world into this one, e.g. a level chunk that was built on a loader thread. Every
+		/// Archetype of the other world is appended as a whole, growing every vector of this world at most once and moving
+		/// the components with a single bulk move per vector. The entities get new ids, parent/child relationships are kept.
+		/// Sparse components need to be declared sparse in this world as well
+		/// \param staging world to take the entities from. Is left empty, but keeps its Archetypes, so it can be filled again
+		/// \param remap if not nullptr, is resized to map every id of the staging world to the id of the entity in this world.
+		/// Ids of entities that did not exist map to Archetype::HOLE_ID
+		void Merge(BasicWorld &staging, std::vector<EntityId> *remap = nullptr) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(&staging != this && "Cannot merge a world into itself");
+			
+			// the relationships are only known by the old ids, so they need the complete mapping
+			std::pmr::vector<EntityId> newIds{&_tempResource};
+			const bool needsRemap = remap != nullptr || not staging._hierarchy.Empty();
+			if (needsRemap)
+			{
+				newIds.assign(staging.PeekNextFreeIndex(), Archetype::HOLE_ID);
+			}
+			
+			for (const std::pair<const MultiIdType, Archetype *> &source : staging._componentContainers)
+			{
+				Archetype &container = *source.second;
+				const auto amount = static_cast<EntityId>(container.Size());
+				if (amount == 0)
+				{
+					continue;
+				}
+				
+				// the entities keep their order, skipping the holes
+				const EntityId firstNewId = ReserveIds(amount);
+				if (needsRemap || not staging._sparseStorages.empty())
+				{
+					EntityId newId = firstNewId;
+					for (const EntityId id : container.GetIds())
+					{
+						if (id == Archetype::HOLE_ID)
+						{
+							continue;
+						}
+						if (needsRemap)
+						{
+							newIds[id] = newId;
+						}
+						if (not staging._sparseStorages.empty())
+						{
+							staging.MoveSparseComponents(*this, id, newId);
+						}
+						++newId;
+					}
+				}
+				container.MoveAllTo(ContainerWithTypesOf(container), firstNewId);
+			}
+			
+			if (not staging._hierarchy.Empty())
+			{
+				staging._hierarchy.ForeachInDepthOrder([&](EntityId child, EntityId parent)
+				                                      {
+					                                      _hierarchy.SetParent(newIds[child], newIds[parent]);
+				                                      });
+				staging._hierarchy.Clear();
+			}
+			if (remap != nullptr)
+			{
+				remap->assign(newIds.cbegin(), newIds.cend());
+			}
+		}
+		
+		/// \param id of an entity of this world, e.g. one created by an EntityStage
+		/// \return a handle to the entity
+		[[nodiscard]] inline Entity GetEntity(EntityId id) FLUFF_NOEXCEPT
+		{
+			assert(Contains(id) && "Entity does not belong to this World");
+			return Entity(id, *this);
+		}
+		
+		/// Gets a component of an entity without knowing its type
+		/// \param entity that owns the wanted component
+		/// \param type id of the component type
+		/// \return a pointer to the component, or nullptr if the entity has none or the type is a tag
+		[[nodiscard]] void *GetRaw(Entity entity, IdType type) FLUFF_NOEXCEPT
+		{
+			assert(Contains(entity.Id()) && "Entity does not belong to this World");
+			if (auto *storage = SparseStorageOf(type)) FLUFF_UNLIKELY
+			{
+				return storage->GetRaw(entity.Id());
+			}
+			
+			Archetype &container = ContainerOf(entity.Id());
+			return container.ContainsType(type) ? container.GetRaw(type, entity.Id()) : nullptr;
+		}
+		
+		/// Copies the components of many entities at once, e.g. of the targets other components refer to. Unlike calling
+		/// Entity::Get for each of them, the ids are resolved in batches: every pass over a batch prefetches what the next
+		/// pass reads, from the Archetype of each entity to its row and its component, so that the cache misses of a batch
+		/// overlap instead of stalling one after another
+		/// \tparam TComponent type to get. Every entity needs to have a component of that type
+		/// \param ids of entities of this world
+		/// \param count number of ids
+		/// \param out array of count elements, set to the components in the same order as ids
+		template<typename TComponent>
+		void GetMany(const EntityId *ids, std::size_t count, TComponent *out) const FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(std::is_same_v<std::decay_t<TComponent>, TComponent>, "Type cannot be reference or pointer");
+			static_assert(not internal::IsEmpty<TComponent>, "Tags have no values to get");
+			
+			if (const internal::SparseStorage *storage = SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					out[i] = storage->template Get<TComponent>(ids[i]);
+				}
+				return;
+			}
+			
+			std::array<const Archetype *, GET_MANY_BATCH_SIZE> containers{};
+			std::array<const TComponent *, GET_MANY_BATCH_SIZE> components{};
+			for (std::size_t begin = 0; begin < count; begin += GET_MANY_BATCH_SIZE)
+			{
+				const EntityId *batch = ids + begin;
+				const std::size_t size = std::min(count - begin, GET_MANY_BATCH_SIZE);
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					PrefetchContainerOf(batch[i]);
+				}
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					assert(Contains(batch[i]) && "Entity does not belong to this World");
+					containers[i] = &ContainerOf(batch[i]);
+					containers[i]->PrefetchIndexOf(batch[i]);
+				}
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					components[i] = &containers[i]->template Get<TComponent>(batch[i]);
+					FLUFF_PREFETCH(components[i]);
+				}
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					out[begin + i] = *components[i];
+				}
+			}
+		}
+		
+		/// Copies the components of many entities at once, see GetMany(const EntityId *, std::size_t, TComponent *)
+		/// \tparam TComponent type to get. Every entity needs to have a component of that type
+		/// \param ids of entities of this world
+		/// \return the components in the same order as ids
+		template<typename TComponent, typename TAllocator>
+		[[nodiscard]] std::vector<TComponent> GetMany(const std::vector<EntityId, TAllocator> &ids) const FLUFF_MAYBE_NOEXCEPT
+		{
+			std::vector<TComponent> components(ids.size());
+			GetMany(ids.data(), ids.size(), components.data());
+			return components;
+		}
+		
+		/// Adds a default constructed component of a registered type to an entity. Does nothing if the entity already has one
+		/// \param entity to add the component to
+		/// \param type id of the registered type
+		/// \return a pointer to the component, or nullptr if the type is a tag
+		void *AddComponentOf(Entity entity, IdType type) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(Contains(entity.Id()) && "Entity does not belong to this World");
+			assert(SparseStorageOf(type) == nullptr && "Sparse components need to be added with AddComponent");
+			
+			Archetype &source = ContainerOf(entity.Id());
+			if (not source.ContainsType(type))
+			{
+				const MultiIdType destinationTypeId = source.GetMultiTypeId() xor type;
+				Archetype *destination{};
+				if (auto found = _componentContainers.find(destinationTypeId); found != _componentContainers.end())
+				{
+					destination = found->second;
+				} else
+				{
+					std::pmr::vector<TypeInformation> tInfos{&_tempResource};
+					std::pmr::vector<internal::ConstructorVTable> constructors{&_tempResource};
+					source.GetSignature(tInfos, constructors);
+					
+					// keep the signature sorted
+					const RuntimeComponent &added = RuntimeComponentOf(type);
+					const auto position = std::upper_bound(tInfos.cbegin(), tInfos.cend(), type,
+					                                       [](IdType id, const TypeInformation &tInfo) { return id < tInfo.id; });
+					constructors.insert(constructors.cbegin() + (position - tInfos.cbegin()), added.constructors);
+					tInfos.insert(position, added.tInfo);
+					
+					destination = &CreateComponentContainerWith(tInfos, constructors, destinationTypeId);
+				}
+				
+				source.MoveEntityTo(*destination, entity.Id());
+				destination->EmplaceDefault(type);
+			}
+			return GetRaw(entity, type);
+		}
+		
+		/// Removes a component from an entity without knowing its type. Does nothing if the entity has none
+		/// \param entity to remove the component from
+		/// \param type id of the component type
+		void RemoveComponentOf(Entity entity, IdType type) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(Contains(entity.Id()) && "Entity does not belong to this World");
+			if (auto *storage = SparseStorageOf(type)) FLUFF_UNLIKELY
+			{
+				storage->Remove(entity.Id());
+				return;
+			}
+			
+			Archetype &source = ContainerOf(entity.Id());
+			if (not source.ContainsType(type))
+			{
+				// nothing to remove
+				return;
+			}
+			
+			const auto combinedTargetIds = source.GetMultiTypeId() xor type;
+			if (_componentContainers.count(combinedTargetIds))
+			{
+				Archetype &destination = *_componentContainers.at(combinedTargetIds);
+				source.MoveEntityTo(destination, entity.Id());
+			} else
+			{
+				// create list of all type information, except the removed one
+				std::pmr::vector<TypeInformation> targetTypes{&_tempResource};
+				std::pmr::vector<internal::ConstructorVTable> targetConstructors{&_tempResource};
+				source.GetSignature(targetTypes, targetConstructors);
+				for (std::size_t i = 0; i < targetTypes.size(); ++i)
+				{
+					if (targetTypes[i].id == type)
+					{
+						targetTypes.erase(targetTypes.cbegin() + (long long) i);
+						targetConstructors.erase(targetConstructors.cbegin() + (long long) i);
+						break;
+					}
+				}
+				
+				auto &destination = CreateComponentContainerWith(targetTypes, targetConstructors, combinedTargetIds);
+				source.MoveEntityTo(destination, entity.Id());
+			}
+		}
+		
+		/// Iterates over all entities having at least the given types, one contiguous range of rows at a time.
+		/// function is called with signature void(std::size_t count, const EntityId *ids, void *const *columns), where
+		/// columns[i] points to the first of count components of types[i], or is nullptr for tags. Entities whose
+		/// components are spread over a group and their Archetype are passed one at a time, and holes left by
+		/// RemovalPolicy::KeepOrder split the rows of an Archetype into multiple ranges. The world may not be changed
+		/// structurally during the iteration
+		/// \param types ids of the component types
+		/// \param count number of types
+		/// \param function to call for every range
+		template<typename TFunc>
+		void ForeachColumns(const IdType *types, std::size_t count, TFunc &&function)
+		FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, std::size_t, const EntityId *, void *const *>)
+		{
+			FLUFF_PROFILE_SCOPE(_profiler, internal::GetTypeName<std::decay_t<TFunc>>());
+			std::pmr::vector<IdType> sortedTypes{types, types + count, &_tempResource};
+			std::sort(sortedTypes.begin(), sortedTypes.end());
+			ForeachColumnsImpl(types, count, sortedTypes, nullptr, 0, false, function);
+		}
+		
+		/// Iterates over all entities matching a query, one contiguous range of rows at a time.
+		/// function is called with signature void(std::size_t count, const EntityId *ids, void *const *columns), where
+		/// columns[i] points to the first of count components of query.GetColumnTypes()[i]. It is nullptr for tags and
+		/// for Optional types the entities do not have. Holes left by RemovalPolicy::KeepOrder split the rows of an
+		/// Archetype into multiple ranges. The world may not be changed structurally during the iteration
+		/// \param query to match the entities with
+		/// \param function to call for every range
+		template<typename TFunc>
+		void ForeachColumns(const DynamicQuery &query, TFunc &&function)
+		FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, std::size_t, const EntityId *, void *const *>)
+		{
+			FLUFF_PROFILE_SCOPE(_profiler, internal::GetTypeName<std::decay_t<TFunc>>());
+			ForeachColumnsImpl(query.GetColumnTypes().data(), query.GetColumnTypes().size(), query.GetRequired(),
+			                   query.GetExcluded().data(), query.GetExcluded().size(), query.HasFilters(), function);
+		}
+		
+		/// Declares a group of component types that are often iterated together. For all entities that have at least
+		/// these types, their components of these types are saved in one dedicated storage instead of being spread
+		/// over many Archetypes. Iterating over a subset of the group types then only needs to go over a single contiguous range.
+		/// Other iterations over some of the group types are still possible, but need an additional lookup per entity.
+		/// Each Archetype can only be part of one group, thus different groups should not share any types
+		/// \tparam TComponents types of the group
+		template<typename ...TComponents>
+		void DeclareGroup() FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(sizeof...(TComponents) != 0, "A group needs at least one type");
+			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
+			(AssertCanBeComponent<TComponents>(), ...);
+			assert((std::none_of(_groups.cbegin(), _groups.cend(), [](const Archetype *group)
+			{
+				return (group->ContainsType(TypeId<TComponents>()) || ...);
+			})) && "Groups may not share types");
+			assert(not (SparseStorageOf(TypeId<TComponents>()) || ...) && "Sparse components cannot be grouped");
+			assert(not (IsDoubleBuffered<TComponents>() || ...) && "Double buffered components cannot be grouped");
+			
+			Archetype &group = CreateGroupImpl(internal::Sort(internal::TypeList<TComponents...>()));
+			
+			// existing containers move their components into the group
+			for (std::pair<const MultiIdType, Archetype *> container : _componentContainers)
+			{
+				if (container.second->GetGroup() == nullptr && (container.second->ContainsType(TypeId<TComponents>()) && ...))
+				{
+					container.second->AttachGroup(group);
+				}
+			}
+		}
+	
+		/// Declares that a component type is saved in its own sparse set instead of in the Archetypes. Adding or removing
+		/// such a component does not move the other components of the entity, which suits components that are toggled often.
+		/// Iterations including the type are driven by the sparse set and look up the other components per entity.
+		/// Has to be called before any entity got a component of that type
+		/// \tparam TComponent type to save sparse
+		template<typename TComponent>
+		void DeclareSparse() FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(std::is_same_v<std::decay_t<TComponent>, TComponent>, "Type cannot be reference or pointer");
+			AssertCanBeComponent<TComponent>();
+			assert(CollectVectorsOf<TComponent>().empty() && "Component type is already saved in Archetypes");
+			
+			auto [storage, inserted] = _sparseStorages.try_emplace(TypeId<TComponent>(), TypeInformation::Of<TComponent>(),
+			                                                       internal::ConstructorVTable::Of<TComponent>(), GetMemoryResource(TypeId<TComponent>()),
+			                                                       _sparseMemory);
+			if (inserted)
+			{
+				storage->second.SetVectorContext(&_vectorContext);
+			}
+		}
+		
+		/// \tparam TComponent type to check
+		/// \return true when the type was declared with DeclareSparse
+		template<typename TComponent>
+		[[nodiscard]] bool IsSparse() const FLUFF_NOEXCEPT
+		{
+			return SparseStorageOf(TypeId<TComponent>()) != nullptr;
+		}
+		
+		/// Declares that a component type is double buffered. Every Archetype keeps a front buffer with the values of the
+		/// type at the last SwapBuffers next to its vector. Systems write the vector as usual while other threads read the
+		/// front buffer with GetPrevious or ForeachPrevious, so neither waits for the other nor touches the same memory.
+		/// The type has to be trivially copyable and may not be sparse or grouped, and the world may not use shared
+		/// column allocation
+		/// \tparam TComponent type to double buffer
+		template<typename TComponent>
+		void DeclareDoubleBuffered() FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(std::is_same_v<std::decay_t<TComponent>, TComponent>, "Type cannot be reference or pointer");
+			static_assert(std::is_trivially_copyable_v<TComponent>, "Only trivially copyable types can be double buffered");
+			static_assert(not internal::IsEmpty<TComponent>, "Empty types cannot be double buffered");
+			AssertCanBeComponent<TComponent>();
+			assert(not IsSparse<TComponent>() && "Sparse components cannot be double buffered");
+			assert(not _sharedColumnAllocation && "Components of worlds with shared column allocation cannot be double buffered");
+			assert(std::none_of(_groups.cbegin(), _groups.cend(), [](const Archetype *group) { return group->ContainsType(TypeId<TComponent>()); }) &&
+			       "Grouped components cannot be double buffered");
+			
+			if (not IsDoubleBuffered<TComponent>())
+			{
+				_doubleBufferedTypes.push_back(TypeId<TComponent>());
+			}
+		}
+		
+		/// \tparam TComponent type to check
+		/// \return true when the type was declared with DeclareDoubleBuffered
+		template<typename TComponent>
+		[[nodiscard]] bool IsDoubleBuffered() const FLUFF_NOEXCEPT
+		{
+			return std::find(_doubleBufferedTypes.cbegin(), _doubleBufferedTypes.cend(), TypeId<TComponent>()) != _doubleBufferedTypes.cend();
+		}
+		
+		/// Makes the current values of all double buffered types the previous ones. The current values stay as they are,
+		/// they are copied with a single memcpy per Archetype and type. Call it at the frame boundary after the structural
+		/// changes of the frame: the previous values are addressed by row, so they belong to other entities once
+		/// entities are added to or removed from their Archetype
+		void SwapBuffers() FLUFF_MAYBE_NOEXCEPT
+		{
+			for (const IdType type : _doubleBufferedTypes)
+			{
+				for (std::pair<const MultiIdType, Archetype *> container : _componentContainers)
+				{
+					if (container.second->ContainsType(type))
+					{
+						container.second->SwapFrontBuffer(type, GetMemoryResource(type));
+					}
+				}
+			}
+		}
+		
+		/// Gets the value of a double buffered component at the last SwapBuffers
+		/// \tparam TComponent double buffered type
+		/// \param id of an entity that had the component at the last swap, without structural changes since
+		/// \return a const reference to the previous value
+		template<typename TComponent>
+		[[nodiscard]] const TComponent &GetPrevious(EntityId id) const FLUFF_NOEXCEPT
+		{
+			assert(IsDoubleBuffered<TComponent>() && "Type is not double buffered");
+			assert(Contains(id) && "Entity does not belong to this World");
+			
+			const Archetype &container = ContainerOf(id);
+			const internal::DynamicVector *front = container.GetFrontBuffer(TypeId<TComponent>());
+			assert(front && container.IndexOf(id) < front->template Size<TComponent>() && "No previous value, SwapBuffers was not called since");
+			return front->template Get<TComponent>(container.IndexOf(id));
+		}
+		
+		/// Iterates over the values of a double buffered type at the last SwapBuffers. Does not change the world, so it may
+		/// run on another thread while systems write the current values
+		/// \tparam TComponent double buffered type
+		/// \param function with signature void(EntityId, const TComponent &)
+		template<typename TComponent, typename TFunc>
+		void ForeachPrevious(TFunc &&function) const FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, EntityId, const TComponent &>)
+		{
+			assert(IsDoubleBuffered<TComponent>() && "Type is not double buffered");
+			for (const std::pair<const MultiIdType, Archetype *> &container : _componentContainers)
+			{
+				const internal::DynamicVector *front = container.second->GetFrontBuffer(TypeId<TComponent>());
+				if (front == nullptr)
+				{
+					continue;
+				}
+				
+				const std::pmr::vector<EntityId> &ids = container.second->GetIds();
+				const TComponent *values = static_cast<const TComponent *>(front->Data());
+				const std::size_t rows = std::min(ids.size(), front->template Size<TComponent>());
+				for (std::size_t row = 0; row < rows; ++row)
+				{
+					if (ids[row] != Archetype::HOLE_ID)
+					{
+						function(ids[row], values[row]);
+					}
+				}
+			}
+		}
+		
+		/// Iterates over a double buffered type, passing the value at the last SwapBuffers together with the current one,
+		/// so that systems compute the current value from the previous one, e.g. current.x = previous.x + velocity.x.
+		/// Entities without a previous value, as they were added after the last swap, get their current value as both
+		/// \tparam TComponent double buffered type
+		/// \param function with signature void(const TComponent &previous, TComponent &current)
+		template<typename TComponent, typename TFunc>
+		void ForeachWithPrevious(TFunc &&function) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, const TComponent &, TComponent &>)
+		{
+			assert(IsDoubleBuffered<TComponent>() && "Type is not double buffered");
+			for (std::pair<const MultiIdType, Archetype *> container : _componentContainers)
+			{
+				if (not container.second->ContainsType(TypeId<TComponent>()))
+				{
+					continue;
+				}
+				
+				const std::pmr::vector<EntityId> &ids = container.second->GetIds();
+				TComponent *values = static_cast<TComponent *>(container.second->template GetVector<TComponent>().Data());
+				const internal::DynamicVector *front = container.second->GetFrontBuffer(TypeId<TComponent>());
+				const TComponent *previousValues = front ? static_cast<const TComponent *>(front->Data()) : values;
+				const std::size_t previousRows = front ? std::min(ids.size(), front->template Size<TComponent>()) : ids.size();
+				for (std::size_t row = 0; row < ids.size(); ++row)
+				{
+					if (ids[row] != Archetype::HOLE_ID)
+					{
+						function(row < previousRows ? previousValues[row] : values[row], values[row]);
+					}
+				}
+			}
+		}
+		
+		/*
+		 * Hierarchy
+		 */
+		
+		/// Makes child a direct child of parent. Destroying the parent destroys all of its children as well
+		/// \param child to attach, it is detached from its previous parent
+		/// \param parent to attach to. May not be a direct or indirect child of child
+		void SetParent(Entity child, Entity parent) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(Contains(child.Id()) && Contains(parent.Id()) && "Entity does not belong to this World");
+			_hierarchy.SetParent(child.Id(), parent.Id());
+		}
+		
+		/// Detaches an entity from its parent. Its own children stay attached to it
+		/// \param child to detach
+		void RemoveParent(Entity child) FLUFF_MAYBE_NOEXCEPT
+		{
+			_hierarchy.RemoveParent(child.Id());
+		}
+		
+		/// \param child entity to get the parent of
+		/// \return true and the parent of child when it has one
+		[[nodiscard]] std::pair<bool, Entity> ParentOf(Entity child) FLUFF_NOEXCEPT
+		{
+			const EntityId parent = _hierarchy.ParentOf(child.Id());
+			if (parent == internal::Hierarchy::NO_ENTITY)
+			{
+				return {false, Entity()};
+			}
+			return {true, Entity(parent, *this)};
+		}
+		
+		/// Calls function for every direct child of parent. Relationships may not be changed during the iteration
+		/// \param parent whose children are visited
+		/// \param function callable with signature void(EntityId)
+		template<typename TFunc>
+		void ForeachChild(Entity parent, TFunc &&function) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, EntityId>)
+		{
+			_hierarchy.ForeachChild(parent.Id(), function);
+		}
+		
+		/// Calls function for every entity that has a parent. All entities are visited breadth-first in a single linear pass,
+		/// so every parent is visited before its children. Relationships may not be changed during the iteration
+		/// \param function callable with signature void(EntityId child, EntityId parent)
+		template<typename TFunc>
+		void ForeachInHierarchy(TFunc &&function) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, EntityId, EntityId>)
+		{
+			_hierarchy.ForeachInDepthOrder(function);
+		}
+		
+		/// Propagates a component from the roots of the hierarchy to the leaves, e.g. to calculate the global transforms.
+		/// Pairs where either the child or the parent do not have the component are skipped. The component of every
+		/// entity in the hierarchy is looked up once up front, the propagation itself then walks the nodes and these
+		/// locations linearly in depth order instead of looking up both entities of every pair
+		/// \tparam TComponent type to propagate
+		/// \param function callable with signature void(const TComponent &parent, TComponent &child)
+		template<typename TComponent, typename TFunc>
+		void Propagate(TFunc &&function) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, const TComponent &, TComponent &>)
+		{
+			static_assert(std::is_same_v<std::decay_t<TComponent>, TComponent>, "Type cannot be reference or pointer");
+			static_assert(std::is_invocable_v<TFunc, const TComponent &, TComponent &>, "Function parameters do not match");
+			static_assert(not internal::IsEmpty<TComponent>, "Empty types cannot be propagated");
+			
+			const std::pmr::vector<internal::Hierarchy::Node> &nodes = _hierarchy.GetNodesInDepthOrder();
+			std::pmr::vector<TComponent *> components(nodes.size(), &_tempResource);
+			if (internal::SparseStorage *storage = SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+			{
+				for (std::size_t i = 0; i < nodes.size(); ++i)
+				{
+					components[i] = storage->Contains(nodes[i].id) ? &storage->template Get<TComponent>(nodes[i].id) : nullptr;
+				}
+			} else
+			{
+				for (std::size_t i = 0; i < nodes.size(); ++i)
+				{
+					Archetype &container = ContainerOf(nodes[i].id);
+					components[i] = container.ContainsType(TypeId<TComponent>()) ? &container.template Get<TComponent>(nodes[i].id) : nullptr;
+				}
+			}
+			
+			for (std::size_t i = 0; i < nodes.size(); ++i)
+			{
+				if (nodes[i].depth != 0 && components[i] != nullptr && components[nodes[i].parentIndex] != nullptr)
+				{
+					function(*components[nodes[i].parentIndex], *components[i]);
+				}
+			}
+		}
+		
+		/// Destroys all entities that have at least the given component types. As every matching Archetype is removed
+		/// as a whole, this is much faster than destroying the entities one by one
+		/// \tparam TComponents the entities need to have to be destroyed
+		template<typename ...TComponents>
+		void DestroyAll() FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
+			
+			if ((SparseStorageOf(TypeId<TComponents>()) || ...) || not _hierarchy.Empty()) FLUFF_UNLIKELY
+			{
+				// entities with sparse components are spread over many Archetypes and children need to be destroyed as well
+				std::pmr::vector<Entity> entities{&_tempResource};
+				auto collect = [&](EntityId id, const TComponents &...) { entities.push_back(Entity(id, *this)); };
+				ForeachEntityImpl(collect, internal::TypeList<TComponents...>());
+				Destroy(entities.data(), entities.size());
+				return;
+			}
+			
+			for (Archetype *container : CollectVectorsOf<TComponents...>())
+			{
+				if (not _sparseStorages.empty())
+				{
+					for (const EntityId id : container->GetIds())
+					{
+						if (id != Archetype::HOLE_ID)
+						{
+							RemoveSparseComponents(id);
+						}
+					}
+				}
+				container->Clear();
+			}
+		}
+		
+		/// Destroys multiple entities at once. All entities of the same Archetype are removed together,
+		/// meaning that each of its vectors is only compacted once
+		/// \param entities to destroy. Entities that are already dead are ignored
+		/// \param count number of entities
+		void Destroy(const Entity *entities, std::size_t count) FLUFF_MAYBE_NOEXCEPT
+		{
+			std::pmr::vector<EntityId> ids{&_tempResource};
+			ids.reserve(count);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const EntityId id = entities[i].Id();
+				if (Contains(id) && ContainerOf(id).ContainsId(id))
+				{
+					ids.push_back(id);
+				}
+			}
+			
+			if (not _hierarchy.Empty()) FLUFF_UNLIKELY
+			{
+				// destroying a parent also destroys all of its children
+				const std::size_t nDirect = ids.size();
+				for (std::size_t i = 0; i < nDirect; ++i)
+				{
+					_hierarchy.CollectDescendants(ids[i], ids);
+				}
+				// leaves first, so that no removal has to update the depths of a subtree
+				for (auto id = ids.crbegin(); id != ids.crend(); ++id)
+				{
+					_hierarchy.Remove(*id);
+				}
+			}
+			for (const EntityId id : ids)
+			{
+				RemoveSparseComponents(id);
+			}
+			
+			// group the ids by their container and sort them by their position in it
+			std::sort(ids.begin(), ids.end(), [this](EntityId lhs, EntityId rhs)
+			{
+				const Archetype *lhsContainer = &ContainerOf(lhs);
+				const Archetype *rhsContainer = &ContainerOf(rhs);
+				if (lhsContainer != rhsContainer)
+				{
+					return std::less<const Archetype *>()(lhsContainer, rhsContainer);
+				}
+				return lhsContainer->IndexOf(lhs) < lhsContainer->IndexOf(rhs);
+			});
+			ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+			
+			for (auto groupBegin = ids.cbegin(); groupBegin != ids.cend();)
+			{
+				Archetype &container = ContainerOf(*groupBegin);
+				auto groupEnd = groupBegin;
+				while (groupEnd != ids.cend() && &ContainerOf(*groupEnd) == &container)
+				{
+					++groupEnd;
+				}
+				
+				container.RemoveSorted(&*groupBegin, &*groupBegin + (groupEnd - groupBegin));
+				groupBegin = groupEnd;
+			}
+		}
+		
+		/// Destroys multiple entities at once
+		/// \param entities to destroy. Entities that are already dead are ignored
+		template<typename TAllocator>
+		void Destroy(const std::vector<Entity, TAllocator> &entities) FLUFF_MAYBE_NOEXCEPT
+		{
+			Destroy(entities.data(), entities.size());
+		}
+		
+		/// Moves an entity with all of its components to another world, e.g. when it crosses into the region of another
+		/// shard. The entity gets a new id in the other world and is dead in this one. Its parent/child relationships are
+		/// removed, sparse components need to be declared sparse in the other world as well
+		/// \param destination world to move the entity to
+		/// \param entity alive entity of this world
+		/// \return the entity in the other world
+		Entity MoveEntityTo(BasicWorld &destination, Entity entity) FLUFF_MAYBE_NOEXCEPT
+		{
+			EntityId movedId = 0;
+			MoveEntitiesTo(destination, &entity, 1, &movedId);
+			return Entity(movedId, destination);
+		}
+		
+		/// Moves multiple entities with all of their components to another world, like MoveEntityTo. All entities of the
+		/// same Archetype are moved together column by column, so every vector of the other world grows at most once
+		/// \param destination world to move the entities to
+		/// \param entities alive and unique entities of this world
+		/// \param count number of entities
+		/// \param movedIds will contain the new id of every entity in the other world, at the same position as in entities
+		void MoveEntitiesTo(BasicWorld &destination, const Entity *entities, std::size_t count, EntityId *movedIds) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(&destination != this && "Entities can only be moved to another world");
+			
+			// group the entities by their container and sort them by their position in it
+			std::pmr::vector<std::size_t> order(count, &_tempResource);
+			std::iota(order.begin(), order.end(), std::size_t(0));
+			std::sort(order.begin(), order.end(), [this, entities](std::size_t lhs, std::size_t rhs)
+			{
+				const Archetype *lhsContainer = &ContainerOf(entities[lhs].Id());
+				const Archetype *rhsContainer = &ContainerOf(entities[rhs].Id());
+				if (lhsContainer != rhsContainer)
+				{
+					return std::less<const Archetype *>()(lhsContainer, rhsContainer);
+				}
+				return lhsContainer->IndexOf(entities[lhs].Id()) < lhsContainer->IndexOf(entities[rhs].Id());
+			});
+			
+			std::pmr::vector<EntityId> ids{&_tempResource};
+			ids.reserve(count);
+			const EntityId firstNewId = destination.ReserveIds(static_cast<EntityId>(count));
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const EntityId id = entities[order[i]].Id();
+				assert(Contains(id) && ContainerOf(id).ContainsId(id) && "Entity is not alive");
+				assert((ids.empty() || ids.back() != id) && "Entities may only be given once");
+				ids.push_back(id);
+				movedIds[order[i]] = firstNewId + i;
+			}
+			
+			// relationships and sparse components belong to the world instead of the Archetypes
+			if (not _hierarchy.Empty()) FLUFF_UNLIKELY
+			{
+				for (const EntityId id : ids)
+				{
+					_hierarchy.Remove(id);
+				}
+			}
+			if (not _sparseStorages.empty()) FLUFF_UNLIKELY
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					MoveSparseComponents(destination, ids[i], firstNewId + i);
+				}
+			}
+			
+			for (std::size_t groupBegin = 0; groupBegin < count;)
+			{
+				Archetype &container = ContainerOf(ids[groupBegin]);
+				std::size_t groupEnd = groupBegin;
+				while (groupEnd < count && &ContainerOf(ids[groupEnd]) == &container)
+				{
+					++groupEnd;
+				}
+				
+				container.MoveRowsTo(destination.ContainerWithTypesOf(container), ids.data() + groupBegin, groupEnd - groupBegin, firstNewId + groupBegin);
+				groupBegin = groupEnd;
+			}
+		}
+		
+		/// Moves multiple entities with all of their components to another world, like MoveEntityTo
+		/// \param destination world to move the entities to
+		/// \param entities alive and unique entities of this world
+		/// \return the entities in the other world, in the same order
+		template<typename TAllocator>
+		std::vector<Entity> MoveEntitiesTo(BasicWorld &destination, const std::vector<Entity, TAllocator> &entities) FLUFF_MAYBE_NOEXCEPT
+		{
+			std::pmr::vector<EntityId> movedIds(entities.size(), &_tempResource);
+			MoveEntitiesTo(destination, entities.data(), entities.size(), movedIds.data());
+			
+			std::vector<Entity> moved{};
+			moved.reserve(movedIds.size());
+			for (const EntityId id : movedIds)
+			{
+				moved.push_back(Entity(id, destination));
+			}
+			return moved;
+		}
+		
+		/// Moves all entities that have at least the given component types to another world, like MoveEntityTo. Every
+		/// matching Archetype is moved as a whole, with a single bulk move per vector
+		/// \tparam TComponents the entities need to have to be moved
+		/// \param destination world to move the entities to
+		template<typename ...TComponents>
+		void MoveAllTo(BasicWorld &destination) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert((std::is_same_v<std::decay_t<TComponents>, TComponents> && ...), "Type cannot be reference or pointer");
+			assert(&destination != this && "Entities can only be moved to another world");
+			
+			if (not _sparseStorages.empty() || not _hierarchy.Empty()) FLUFF_UNLIKELY
+			{
+				std::pmr::vector<Entity> entities{&_tempResource};
+				auto collect = [&](EntityId id, const TComponents &...) { entities.push_back(Entity(id, *this)); };
+				ForeachEntityImpl(collect, internal::TypeList<TComponents...>());
+				std::pmr::vector<EntityId> movedIds(entities.size(), &_tempResource);
+				MoveEntitiesTo(destination, entities.data(), entities.size(), movedIds.data());
+				return;
+			}
+			
+			for (Archetype *container : CollectVectorsOf<TComponents...>())
+			{
+				if (const auto amount = static_cast<EntityId>(container->Size()); amount != 0)
+				{
+					container->MoveAllTo(destination.ContainerWithTypesOf(*container), destination.ReserveIds(amount));
+				}
+			}
+		}
+	
+		/// Sorts the entities of every Archetype containing TComponent, so that following iterations visit them in that order.
+		/// Equal elements keep their relative order
+		/// \tparam TComponent to sort by
+		/// \param compare callable with signature bool(const TComponent &, const TComponent &), returning true when the first element shall be first
+		/// \param mode SortMode::Incremental is faster for data that is already mostly sorted
+		template<typename TComponent, typename TCompare>
+		void Sort(TCompare &&compare, SortMode mode = SortMode::Full) FLUFF_MAYBE_NOEXCEPT
+		{
+			static_assert(std::is_same_v<std::decay_t<TComponent>, TComponent>, "Type cannot be reference or pointer");
+			static_assert(std::is_invocable_r_v<bool, TCompare, const TComponent &, const TComponent &>, "Invalid comparison function");
+			
+			for (Archetype *container : CollectVectorsOf<TComponent>())
+			{
+				container->template Sort<TComponent>(compare, mode, _sortBuffer);
+			}
+			
+			// grouped components are sorted inside of their group
+			for (Archetype *group : _groups)
+			{
+				if (group->ContainsType(TypeId<TComponent>()))
+				{
+					group->template Sort<TComponent>(compare, mode, _sortBuffer);
+				}
+			}
+		}
+		
+		/// Sets how single entities are removed from their Archetypes. RemovalPolicy::KeepOrder keeps the iteration order
+		/// independent of when entities are destroyed or change their components, which is needed for deterministic simulations
+		/// \param policy to use for all current and future Archetypes
+		void SetRemovalPolicy(RemovalPolicy policy) FLUFF_NOEXCEPT
+		{
+			_removalPolicy = policy;
+			for (std::pair<const MultiIdType, Archetype *> container : _componentContainers)
+			{
+				container.second->SetRemovalPolicy(policy);
+			}
+			for (Archetype *group : _groups)
+			{
+				group->SetRemovalPolicy(policy);
+			}
+		}
+		
+		[[nodiscard]] RemovalPolicy GetRemovalPolicy() const FLUFF_NOEXCEPT
+		{
+			return _removalPolicy;
+		}
+		
+		/// Closes all holes left by removals when using RemovalPolicy::KeepOrder. Should be called at a sync point,
+		/// e.g. at the end of a frame
+		void Compact() FLUFF_MAYBE_NOEXCEPT
+		{
+			for (std::pair<const MultiIdType, Archetype *> container : _componentContainers)
+			{
+				container.second->Compact();
+			}
+			for (Archetype *group : _groups)
+			{
+				group->Compact();
+			}
+		}
+		
+		/// Sets how the component vectors of this world grow and when they are trimmed after removals
+		/// \param policy to use for all current and future vectors
+		void SetGrowthPolicy(const GrowthPolicy &policy) FLUFF_NOEXCEPT
+		{
+			_vectorContext.growthPolicy = policy;
+		}
+		
+		[[nodiscard]] const GrowthPolicy &GetGrowthPolicy() const FLUFF_NOEXCEPT
+		{
+			return _vectorContext.growthPolicy;
+		}
+		
+		/// Sets whether the component vectors of each Archetype are saved in a single allocation with a shared capacity.
+		/// All vectors of an Archetype then grow together with one allocation per growth step and are close to each other
+		/// in memory, which helps iterations over multiple components
+		/// \param enabled true to use one allocation per Archetype, false for one allocation per vector. Applies to all current and future Archetypes
+		void SetSharedColumnAllocation(bool enabled) FLUFF_MAYBE_NOEXCEPT
+		{
+			assert(not (enabled && not _doubleBufferedTypes.empty()) && "Worlds with double buffered components cannot share column allocations");
+			_sharedColumnAllocation = enabled;
+			for (std::pair<const MultiIdType, Archetype *> container : _componentContainers)
+			{
+				container.second->SetSharedAllocation(enabled);
+			}
+			for (Archetype *group : _groups)
+			{
+				group->SetSharedAllocation(enabled);
+			}
+		}
+		
+		[[nodiscard]] bool HasSharedColumnAllocation() const FLUFF_NOEXCEPT
+		{
+			return _sharedColumnAllocation;
+		}
+		
+		/// Closes all holes and gives all memory of the component vectors back that is not needed for the current
+		/// entities, e.g. after destroying a wave of temporary entities. Should be called at a sync point
+		void ShrinkToFit() FLUFF_MAYBE_NOEXCEPT
+		{
+			for (std::pair<const MultiIdType, Archetype *> container : _componentContainers)
+			{
+				container.second->ShrinkToFit();
+			}
+			for (Archetype *group : _groups)
+			{
+				group->ShrinkToFit();
+			}
+			for (auto &storage : _sparseStorages)
+			{
+				storage.second.ShrinkToFit();
+			}
+			_sortBuffer.clear();
+			_sortBuffer.shrink_to_fit();
+		}
+		
+		/// \return the number of bytes currently reserved by the component vectors of this world
+		[[nodiscard]] std::size_t GetComponentByteCapacity() const FLUFF_NOEXCEPT
+		{
+			return _vectorContext.byteCapacity;
+		}
+		
+		/// \return the largest number of bytes the component vectors of this world ever reserved at the same time
+		[[nodiscard]] std::size_t GetPeakComponentByteCapacity() const FLUFF_NOEXCEPT
+		{
+			return _vectorContext.peakByteCapacity;
+		}
+
+#ifdef FLUFF_PROFILE
+		
+		/// The profiler records an event for every Foreach, ForeachEntity and ForeachColumns, named after the type of the
+		/// callable, with the number of visited entities and Archetypes. Wrap systems in FLUFF_PROFILE_SCOPE(world.GetProfiler(), "Name")
+		/// to nest the iterations in them. Queries through a BasicWorldView are not recorded, as they may run on
+		/// multiple threads at once and the profiler is not synchronized. Only available if FLUFF_PROFILE is defined
+		/// \return the profiler of this world
+		[[nodiscard]] inline Profiler &GetProfiler() FLUFF_NOEXCEPT
+		{
+			return _profiler;
+		}
+		
+		[[nodiscard]] inline const Profiler &GetProfiler() const FLUFF_NOEXCEPT
+		{
+			return _profiler;
+		}
+
+#endif
+		
+		/// Sums up the memory of all Archetypes, groups and sparse storages. Does not allocate, so it can be sampled every frame
+		/// \return the memory used by this world
+		[[nodiscard]] WorldMemoryStats GetMemoryStats() const FLUFF_NOEXCEPT
+		{
+			WorldMemoryStats stats{};
+			stats.archetypeCount = _componentContainers.size();
+			stats.groupCount = _groups.size();
+			for (const std::pair<const MultiIdType, Archetype *> &container : _componentContainers)
+			{
+				const ArchetypeMemoryStats containerStats = container.second->GetMemoryStats();
+				stats.entityCount += containerStats.entityCount;
+				stats.usedBytes += containerStats.usedBytes;
+				stats.idBytes += containerStats.idBytes;
+			}
+			for (const Archetype *group : _groups)
+			{
+				const ArchetypeMemoryStats groupStats = group->GetMemoryStats();
+				stats.usedBytes += groupStats.usedBytes;
+				stats.idBytes += groupStats.idBytes;
+			}
+			for (const auto &storage : _sparseStorages)
+			{
+				stats.usedBytes += storage.second.GetColumnMemory().usedBytes;
+				stats.idBytes += storage.second.IdByteCapacity();
+			}
+			stats.reservedBytes = _vectorContext.byteCapacity;
+			stats.peakReservedBytes = _vectorContext.peakByteCapacity;
+			stats.entityLookupBytes = EntityLookupByteCapacity();
+			return stats;
+		}
+		
+		/// Calls a function with the memory of every Archetype and group. The Archetype can be used to look at its single columns
+		/// \param function with signature void(const ArchetypeMemoryStats &, const Archetype &)
+		template<typename TFunc>
+		void ForeachArchetypeMemory(TFunc &&function) const
+		{
+			for (const std::pair<const MultiIdType, Archetype *> &container : _componentContainers)
+			{
+				function(container.second->GetMemoryStats(), static_cast<const Archetype &>(*container.second));
+			}
+			for (const Archetype *group : _groups)
+			{
+				ArchetypeMemoryStats groupStats = group->GetMemoryStats();
+				groupStats.isGroup = true;
+				function(static_cast<const ArchetypeMemoryStats &>(groupStats), *group);
+			}
+		}
+		
+		/// Sums up the memory of the components of a type over all Archetypes, groups and sparse storages
+		/// \param type id of the component type
+		/// \return the memory used by the components of that type
+		[[nodiscard]] ColumnMemoryStats GetComponentMemory(IdType type) const FLUFF_NOEXCEPT
+		{
+			ColumnMemoryStats stats{type};
+			const auto addColumns = [&stats, type](const Archetype &container)
+			{
+				for (Archetype::IndexType i = 0; i < container.ColumnCount(); ++i)
+				{
+					if (const ColumnMemoryStats column = container.GetColumnMemory(i); column.type == type)
+					{
+						stats.usedBytes += column.usedBytes;
+						stats.reservedBytes += column.reservedBytes;
+					}
+				}
+			};
+			
+			for (const std::pair<const MultiIdType, Archetype *> &container : _componentContainers)
+			{
+				addColumns(*container.second);
+			}
+			for (const Archetype *group : _groups)
+			{
+				addColumns(*group);
+			}
+			if (const internal::SparseStorage *storage = SparseStorageOf(type))
+			{
+				const ColumnMemoryStats column = storage->GetColumnMemory();
+				stats.usedBytes += column.usedBytes;
+				stats.reservedBytes += column.reservedBytes;
+			}
+			return stats;
+		}
+		
+		/// \tparam TComponent component type
+		/// \return the memory used by the components of that type
+		template<typename TComponent>
+		[[nodiscard]] ColumnMemoryStats GetComponentMemory() const FLUFF_NOEXCEPT
+		{
+			return GetComponentMemory(TypeId<TComponent>());
+		}
+		
+		/// \return the structural changes of this world since its creation or the last ResetStructuralChangeStats
+		[[nodiscard]] inline const StructuralChangeStats &GetStructuralChangeStats() const FLUFF_NOEXCEPT
+		{
+			return _vectorContext.changes;
+		}
+		
+		/// Calls function for every transition between two Archetypes that entities were moved along since the
+		/// creation of this world or the last ResetStructuralChangeStats
+		/// \param function with signature void(const TransitionStats &)
+		template<typename TFunc>
+		void ForeachTransition(TFunc &&function) const
+		{
+			for (const std::pair<const MultiIdType, Archetype *> &container : _componentContainers)
+			{
+				container.second->ForeachTransition(function);
+			}
+		}
+		
+		/// Sets all structural change counters to zero, e.g. at the start of every frame. Does not allocate
+		void ResetStructuralChangeStats() FLUFF_NOEXCEPT
+		{
+			_vectorContext.changes = {};
+			for (const std::pair<const MultiIdType, Archetype *> &container : _componentContainers)
+			{
+				container.second->ResetTransitionCounts();
+			}
+		}
+	
+	public:
+		/// Checks whether a given type can be used as a component for this ECS. It needs to be default
+		/// constructible, copy constructible and move constructible
+		/// \tparam TComponent type to check
+		/// \return whether this is usable as a component type
+		template<typename TComponent>
+		static constexpr void AssertCanBeComponent() FLUFF_NOEXCEPT
+		{
+			static_assert(std::is_default_constructible_v<TComponent>, "Type is missing a default constructor");
+			static_assert(std::is_copy_constructible_v<TComponent> || std::is_move_constructible_v<TComponent>,
+			              "Type needs to have at least either a copy or a move constructor");
+			static_assert(not std::is_same_v<TComponent, EntityId>, "Type may not be std::size_t!");
+		}
+	
+	private:
+		/// Iterates over all components of the given types.
+		/// \tparam TComponents Entity need to have at minimum to be iterated over
+		/// \param function to apply on them
+		template<typename ...TComponents, typename TFunc>
+		void ForeachImpl(TFunc &function, internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			static_assert(((not std::is_pointer_v<TComponents>) && ...), "Type cannot be a pointer");
+			static_assert(std::is_invocable_v<TFunc, TComponents...>, "Function parameters do not match with given template parameters");
+			static_assert(not IsFirstEntityId<TComponents...>(), "Disallowed use of an EntityId as first argument. Did you mean ForeachEntity?");
+			
+			if ((SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...)) FLUFF_UNLIKELY
+			{
+				ForeachSparseImpl<false, false, TComponents...>(function, std::index_sequence_for<TComponents...>());
+				return;
+			}
+			
+			// new containers may be appended to the cached list during the iteration, so it is walked by index
+			const std::vector<Archetype *> &containers = CachedVectorsOf<ValueType<TComponents>...>();
+			
+			// groups that contain all wanted types cover all of their containers in a single range
+			for (Archetype *group : _groups)
+			{
+				if ((group->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+				{
+					FLUFF_PROFILE_VISIT(_profiler, group->Size());
+					ForeachInContainer<TComponents...>(function, *group);
+				}
+			}
+			
+			for (std::size_t i = 0; i < containers.size(); ++i)
+			{
+				Archetype *container = containers[i];
+				const Archetype *group = container->GetGroup();
+				if (group == nullptr || not (container->IsGroupedType(TypeId<ValueType<TComponents>>()) || ...)) FLUFF_LIKELY
+				{
+					FLUFF_PROFILE_VISIT(_profiler, container->Size());
+					ForeachInContainer<TComponents...>(function, *container);
+				} else if (not (group->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+				{
+					FLUFF_PROFILE_VISIT(_profiler, container->Size());
+					ForeachInGroupedContainer<false, TComponents...>(function, *container);
+				}
+			}
+		}
+		
+		/// Iterates over all components of the given types.
+		/// \tparam TComponents Entity need to have at minimum to be iterated over
+		/// \param function to apply on them
+		template<typename ...TComponents, typename TFunc>
+		void ForeachEntityImpl(TFunc &function, internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			static_assert(((not std::is_pointer_v<TComponents>) && ...), "Type cannot be a pointer");
+			static_assert(std::is_invocable_v<TFunc, EntityId, TComponents...>,
+					"Function parameters do not match with given template parameters or missing an flf::EntityId as the first parameter");
+			if ((SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...)) FLUFF_UNLIKELY
+			{
+				ForeachSparseImpl<true, false, TComponents...>(function, std::index_sequence_for<TComponents...>());
+				return;
+			}
+			
+			// new containers may be appended to the cached list during the iteration, so it is walked by index
+			const std::vector<Archetype *> &containers = CachedVectorsOf<ValueType<TComponents>...>();
+			
+			// groups that contain all wanted types cover all of their containers in a single range
+			if constexpr (sizeof...(TComponents) != 0)
+			{
+				for (Archetype *group : _groups)
+				{
+					if ((group->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+					{
+						FLUFF_PROFILE_VISIT(_profiler, group->Size());
+						ForeachEntityInContainer<TComponents...>(function, *group);
+					}
+				}
+			}
+			
+			for (std::size_t i = 0; i < containers.size(); ++i)
+			{
+				Archetype *container = containers[i];
+				const Archetype *group = container->GetGroup();
+				if (group == nullptr || not (container->IsGroupedType(TypeId<ValueType<TComponents>>()) || ...)) FLUFF_LIKELY
+				{
+					FLUFF_PROFILE_VISIT(_profiler, container->Size());
+					ForeachEntityInContainer<TComponents...>(function, *container);
+				} else if (not (group->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+				{
+					FLUFF_PROFILE_VISIT(_profiler, container->Size());
+					ForeachInGroupedContainer<true, TComponents...>(function, *container);
+				}
+			}
+		}
+		
+		/// Iterates over all components of the given types like ForeachImpl and ForeachEntityImpl, without changing anything
+		/// in the world, not even the query caches or the profiler. Containers of types that were never iterated over
+		/// before are searched for instead. Used by BasicWorldView
+		/// \tparam WITH_ENTITY whether the callable takes the EntityId as the first argument
+		/// \tparam TComponents Entity need to have at minimum to be iterated over, only const references or values
+		/// \param function to apply on them
+		template<bool WITH_ENTITY, typename ...TComponents, typename TFunc>
+		void ForeachReadOnlyImpl(TFunc &function, internal::TypeList<TComponents...>) const FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			static_assert(((not std::is_pointer_v<TComponents>) && ...), "Type cannot be a pointer");
+			static_assert(((not std::is_reference_v<TComponents> || std::is_const_v<std::remove_reference_t<TComponents>>) && ...),
+			              "Components can only be read, take them by const reference or by value");
+			// the containers are only read, they are accessed mutably because the iteration is shared with Foreach, which
+			// skips the profiler on this path
+			auto &world = const_cast<BasicWorld &>(*this);
+			
+			if ((SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...)) FLUFF_UNLIKELY
+			{
+				world.template ForeachSparseImpl<WITH_ENTITY, true, TComponents...>(function, std::index_sequence_for<TComponents...>());
+				return;
+			}
+			
+			const auto foreachIn = [&function](Archetype &container)
+			{
+				if constexpr (WITH_ENTITY)
+				{
+					ForeachEntityInContainer<TComponents...>(function, container);
+				} else
+				{
+					ForeachInContainer<TComponents...>(function, container);
+				}
+			};
+			
+			// groups that contain all wanted types cover all of their containers in a single range
+			if constexpr (not WITH_ENTITY || sizeof...(TComponents) != 0)
+			{
+				for (Archetype *group : _groups)
+				{
+					if ((group->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+					{
+						foreachIn(*group);
+					}
+				}
+			}
+			
+			const auto foreachContainer = [&function, &foreachIn](Archetype &container)
+			{
+				const Archetype *group = container.GetGroup();
+				if (group == nullptr || not (container.IsGroupedType(TypeId<ValueType<TComponents>>()) || ...)) FLUFF_LIKELY
+				{
+					foreachIn(container);
+				} else if (not (group->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+				{
+					ForeachInGroupedContainer<WITH_ENTITY, TComponents...>(function, container);
+				}
+			};
+			
+			constexpr std::array<IdType, sizeof...(TComponents)> types = SortedTypeIdList<ValueType<TComponents>...>();
+			if (const std::vector<Archetype *> *containers = FindCachedVectorsOf(types.data(), types.size())) FLUFF_LIKELY
+			{
+				for (Archetype *container : *containers)
+				{
+					foreachContainer(*container);
+				}
+				return;
+			}
+			
+			for (const std::pair<const MultiIdType, Archetype *> &container : _componentContainers)
+			{
+				if ((container.second->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+				{
+					foreachContainer(*container.second);
+				}
+			}
+		}
+		
+		/// Iterates over all components of the given types, while all parameters of type Res<T> are resolved only once
+		/// \tparam WITH_ENTITY whether the callable takes the EntityId as the first argument
+		/// \tparam TArgs arguments of the callable, except for the EntityId
+		/// \param function to apply on them
+		template<bool WITH_ENTITY, typename ...TArgs, typename TFunc, std::size_t ...Is>
+		void ForeachWithResources(TFunc &function, internal::TypeList<TArgs...>, std::index_sequence<Is...>) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			const auto resources = GetResources(internal::OnlyResources(internal::TypeList<TArgs...>()));
+			
+			if constexpr (WITH_ENTITY)
+			{
+				auto withResources = [&](EntityId id, auto &&...components) -> void
+				{
+					auto componentRefs = std::forward_as_tuple(std::forward<decltype(components)>(components)...);
+					function(id, PickArgument<TArgs, internal::ResourcePartitionIndices<TArgs...>()[Is]>(componentRefs, resources)...);
+				};
+				ForeachEntityImpl(withResources, internal::RemoveResources(internal::TypeList<TArgs...>()));
+			} else
+			{
+				auto withResources = [&](auto &&...components) -> void
+				{
+					auto componentRefs = std::forward_as_tuple(std::forward<decltype(components)>(components)...);
+					function(PickArgument<TArgs, internal::ResourcePartitionIndices<TArgs...>()[Is]>(componentRefs, resources)...);
+				};
+				ForeachImpl(withResources, internal::RemoveResources(internal::TypeList<TArgs...>()));
+			}
+		}
+		
+		/// \tparam TResources Res types
+		/// \return a tuple with a Res for every given type
+		template<typename ...TResources>
+		std::tuple<TResources...> GetResources(internal::TypeList<TResources...>) FLUFF_NOEXCEPT
+		{
+			return {TResources(Resource<std::remove_const_t<std::remove_reference_t<decltype(*std::declval<TResources>())>>>())...};
+		}
+		
+		/// Selects an argument of a callable either from the components or from the resources
+		/// \tparam TArg type of the argument
+		/// \tparam INDEX of the argument in either the components or the resources
+		/// \param components tuple of references to the components
+		/// \param resources tuple of all resolved resources
+		/// \return the argument
+		template<typename TArg, std::size_t INDEX, typename TComponentTuple, typename TResourceTuple>
+		static constexpr decltype(auto) PickArgument(TComponentTuple &components, const TResourceTuple &resources) FLUFF_NOEXCEPT
+		{
+			if constexpr (internal::IsRes<TArg>)
+			{
+				return std::get<INDEX>(resources);
+			} else
+			{
+				return std::get<INDEX>(std::move(components));
+			}
+		}
+		
+		/// Destructs a resource and frees its memory
+		/// \param slot of the resource
+		void DestroyResource(ResourceSlot &slot) FLUFF_NOEXCEPT
+		{
+			if (slot.data != nullptr)
+			{
+				slot.destruct(slot.data);
+				_containerResource.deallocate(slot.data, slot.size, slot.alignment);
+				slot.data = nullptr;
+			}
+		}
+		
+		/// Iterates over all entities that have the given types, where at least one type is saved sparse.
+		/// The smallest sparse storage decides which entities are checked
+		/// \tparam WITH_ENTITY whether to pass the EntityId as the first argument
+		/// \tparam READ_ONLY whether the iteration may run on reader threads, which must not record it in the profiler
+		/// \tparam TComponents to iterate over
+		/// \param function to apply on them
+		template<bool WITH_ENTITY, bool READ_ONLY, typename ...TComponents, typename TFunc, std::size_t ...Is>
+		void ForeachSparseImpl(TFunc &&function, std::index_sequence<Is...>) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			const std::array<internal::SparseStorage *, sizeof...(TComponents)> storages{SparseStorageOf(TypeId<ValueType<TComponents>>())...};
+			
+			const internal::SparseStorage *smallest = nullptr;
+			for (const internal::SparseStorage *storage : storages)
+			{
+				if (storage != nullptr && (smallest == nullptr || storage->Size() < smallest->Size()))
+				{
+					smallest = storage;
+				}
+			}
+			
+			// the smallest storage is counted like a single Archetype
+			if constexpr (not READ_ONLY)
+			{
+				FLUFF_PROFILE_VISIT(_profiler, smallest->Size());
+			}
+			for (const EntityId id : smallest->GetIds())
+			{
+				Archetype &container = ContainerOf(id);
+				if (not ((storages[Is] != nullptr ? storages[Is]->Contains(id) : container.ContainsType(TypeId<ValueType<TComponents>>())) && ...))
+				{
+					continue;
+				}
+				
+				if constexpr (WITH_ENTITY)
+				{
+					function(id, GetSparseOrLocal<TComponents>(storages[Is], container, id)...);
+				} else
+				{
+					function(GetSparseOrLocal<TComponents>(storages[Is], container, id)...);
+				}
+			}
+		}
+		
+		/// Gets a component either from its sparse storage or from the Archetype of the entity.
+		/// Returns a new element by value if IsEmpty<T> evaluates to true
+		/// \tparam T type to get
+		/// \param storage of the type or nullptr if it is saved in the Archetypes
+		/// \param container of the entity
+		/// \param id of the entity
+		/// \return a reference to the component
+		template<typename T>
+		static decltype(auto) GetSparseOrLocal(internal::SparseStorage *storage, Archetype &container, EntityId id) FLUFF_NOEXCEPT
+		{
+			if constexpr (internal::IsEmpty<std::remove_reference_t<T>>)
+			{
+				static_assert(not std::is_reference_v<T>, "Has to get empty type by value");
+				return ValueType<T>();
+			} else if (storage != nullptr)
+			{
+				return static_cast<std::remove_reference_t<T> &>(storage->template Get<ValueType<T>>(id));
+			} else
+			{
+				return static_cast<std::remove_reference_t<T> &>(container.template Get<ValueType<T>>(id));
+			}
+		}
+		
+		/// Adds a single component to an entity, either to its sparse storage or by moving the entity to another Archetype
+		/// \tparam TComponent type to add
+		/// \param entity to add the component to
+		/// \param component to add
+		template<typename TComponent>
+		void AddSingleComponent(Entity entity, TComponent &&component) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (auto *storage = SparseStorageOf(TypeId<TComponent>()))
+			{
+				storage->template Emplace<TComponent>(entity.Id(), std::forward<TComponent>(component));
+			} else
+			{
+				Archetype &destination = AddComponentMoveImpl<TComponent>(entity);
+				destination.template EmplaceComponent<TComponent>(std::forward<TComponent>(component));
+			}
+		}
+		
+		/// Iterates over all components of the given types in a single container
+		/// \tparam TComponents need to have a vector in the container
+		/// \param function to apply on them
+		/// \param container to iterate over
+		template<typename ...TComponents, typename TFunc>
+		static void ForeachInContainer(TFunc &function, Archetype &container) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			// check index of non-empty type to allow more optimizations
+			using IndexCheckType = std::remove_reference_t<typename internal::FirstNonEmpty<TComponents...>> *;
+			
+			auto current = container.template RawBegin<std::remove_reference_t<TComponents>...>();
+			const auto ends = container.template RawEnd<std::remove_reference_t<TComponents>...>();
+			
+			// holes only exist when using RemovalPolicy::KeepOrder, we skip them segment by segment
+			Archetype::IndexType row = 0;
+			for (const Archetype::IndexType hole : container.GetHoles())
+			{
+				for (; row < hole; ++row)
+				{
+					function(GetFromTuple<TComponents>(current)...);
+					IncrementElements(current);
+				}
+				IncrementElements(current);
+				++row;
+			}
+			
+			while (std::get<IndexCheckType>(current) < std::get<IndexCheckType>(ends))
+			{
+				function(GetFromTuple<TComponents>(current)...);
+				IncrementElements(current);
+			}
 		}
 		
-		template<typename TComponentToRemove>
-		void RemoveComponent(Entity entity) FLUFF_MAYBE_NOEXCEPT
+		/// Iterates over all components of the given types and their entities in a single container
+		/// \tparam TComponents need to have a vector in the container
+		/// \param function to apply on them
+		/// \param container to iterate over
+		template<typename ...TComponents, typename TFunc>
+		static void ForeachEntityInContainer(TFunc &function, Archetype &container) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
 		{
-			static_assert(std::is_same_v<std::decay_t<TComponentToRemove>, TComponentToRemove>, "Type cannot be reference or pointer");
-			AssertCanBeComponent<TComponentToRemove>();
-			
-			assert(Contains(entity.Id()) && "Entity does not belong to this World");
-			Archetype &source = ContainerOf(entity.Id());
+			auto current = container.template RawBeginWithEntity<std::remove_reference_t<TComponents>...>();
+			const auto ends = container.template RawEndWithEntity<std::remove_reference_t<TComponents>...>();
 			
-			const auto &sourceTInfo = source.GetContainedTypes();
-			std::pmr::vector<IdType> targetIds{&_tempResource};
-			targetIds.reserve(sourceTInfo.size() - 1);
-			
-			for (auto i : sourceTInfo)
+			// holes only exist when using RemovalPolicy::KeepOrder, we skip them segment by segment
+			Archetype::IndexType row = 0;
+			for (const Archetype::IndexType hole : container.GetHoles())
 			{
-				// don't add the type id we actually want to remove
-				if (i.id != TypeId<TComponentToRemove>())
+				for (; row < hole; ++row)
 				{
-					targetIds.push_back(i.id);
+					function(*std::get<EntityId *>(current), GetFromTuple<TComponents>(current)...);
+					IncrementElements(current);
 				}
+				IncrementElements(current);
+				++row;
 			}
 			
-			
-			const auto combinedTargetIds = internal::CombineIds(targetIds.cbegin(), targetIds.cend());
-			if (_componentContainers.count(combinedTargetIds))
+			while (std::get<EntityId *>(current) < std::get<EntityId *>(ends))
 			{
-				Archetype &destination = *_componentContainers.at(combinedTargetIds);
-				source.MoveEntityTo(destination, entity.Id());
-			} else
+				function(*std::get<EntityId *>(current), GetFromTuple<TComponents>(current)...);
+				IncrementElements(current);
+			}
+		}
+		
+		/// Iterates over all components of the given types in a container where some of them are saved in its group.
+		/// The grouped components are looked up for every entity
+		/// \tparam WITH_ENTITY whether to pass the EntityId as the first argument
+		/// \tparam TComponents to iterate over
+		/// \param function to apply on them
+		/// \param container to iterate over
+		template<bool WITH_ENTITY, typename ...TComponents, typename TFunc>
+		static void ForeachInGroupedContainer(TFunc &function, Archetype &container) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			auto columns = GetColumns(container, NonEmptyTypeList<std::remove_reference_t<TComponents>...>());
+			const Archetype &group = *container.GetGroup();
+			const auto &ids = container.GetIds();
+			
+			for (Archetype::IndexType row = 0; row < ids.size(); ++row)
 			{
-				auto &sourceConstructors = source.GetConstructorTable();
-				
-				// create list of all type information
-				std::pmr::vector<TypeInformation> targetTypes{&_tempResource};
-				std::pmr::vector<internal::ConstructorVTable> targetConstructors{&_tempResource};
-				targetTypes.reserve(targetIds.size());
-				targetConstructors.reserve(targetIds.size());
-				for (std::size_t i = 0; i < targetIds.size(); ++i)
+				const EntityId id = ids[row];
+				if (id == Archetype::HOLE_ID) FLUFF_UNLIKELY
 				{
-					if (sourceTInfo[i].id != TypeId<TComponentToRemove>())
-					{
-						targetTypes.push_back(sourceTInfo[i]);
-						targetConstructors.push_back(sourceConstructors[i]);
-					}
+					continue;
 				}
 				
-				auto &destination = CreateComponentContainerWith(targetTypes, targetConstructors, combinedTargetIds);
-				source.MoveEntityTo(destination, entity.Id());
+				const Archetype::IndexType groupRow = group.IndexOf(id);
+				if constexpr (WITH_ENTITY)
+				{
+					function(id, GetFromColumns<TComponents>(columns, row, groupRow)...);
+				} else
+				{
+					function(GetFromColumns<TComponents>(columns, row, groupRow)...);
+				}
 			}
 		}
-	
-	public:
-		/// Checks whether a given type can be used as a component for this ECS. It needs to be default
-		/// constructible, copy constructible and move constructible
-		/// \tparam TComponent type to check
-		/// \return whether this is usable as a component type
-		template<typename TComponent>
-		static constexpr void AssertCanBeComponent() FLUFF_NOEXCEPT
-		{
-			static_assert(std::is_default_constructible_v<TComponent>, "Type is missing a default constructor");
-			static_assert(std::is_copy_constructible_v<TComponent> || std::is_move_constructible_v<TComponent>,
-			              "Type needs to have at least either a copy or a move constructor");
-			static_assert(not std::is_same_v<TComponent, EntityId>, "Type may not be std::size_t!");
-		}
-	
-	private:
-		/// Iterates over all components of the given types.
-		/// \tparam TComponents Entity need to have at minimum to be iterated over
+		
+		/// Iterates over a range of rows of a container. Grouped components are looked up for every entity, holes are skipped
+		/// \tparam WITH_ENTITY whether to pass the EntityId as the first argument
+		/// \tparam TComponents to iterate over
 		/// \param function to apply on them
-		template<typename ...TComponents, typename TFunc>
-		void ForeachImpl(TFunc &function, internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		/// \param chunk rows to iterate over
+		template<bool WITH_ENTITY, typename ...TComponents, typename TFunc>
+		static void ForeachInChunk(TFunc &function, const internal::QueryChunk &chunk) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
 		{
-			static_assert(((not std::is_pointer_v<TComponents>) && ...), "Type cannot be a pointer");
-			static_assert(std::is_invocable_v<TFunc, TComponents...>, "Function parameters do not match with given template parameters");
-			static_assert(not IsFirstEntityId<TComponents...>(), "Disallowed use of an EntityId as first argument. Did you mean ForeachEntity?");
-			
-			// check index of non-empty type to allow more optimizations
-			using IndexCheckType = std::remove_reference_t<typename internal::FirstNonEmpty<TComponents...>> *;
+			Archetype &container = *chunk.container;
+			auto columns = GetColumns(container, NonEmptyTypeList<std::remove_reference_t<TComponents>...>());
+			const Archetype *group = container.GetGroup();
+			const bool lookupGroup = group != nullptr && (container.IsGroupedType(TypeId<ValueType<TComponents>>()) || ...);
+			const EntityId *const ids = container.GetIds().data();
 			
-			std::vector<Archetype *> containers = CollectVectorsOf<ValueType<TComponents>...>();
-			
-			for (Archetype *container : containers)
+			for (Archetype::IndexType row = chunk.beginRow; row < chunk.endRow; ++row)
 			{
-				auto current = container->template RawBegin<std::remove_reference_t<TComponents>...>();
-				const auto ends = container->template RawEnd<std::remove_reference_t<TComponents>...>();
-				while (std::get<IndexCheckType>(current) < std::get<IndexCheckType>(ends))
+				const EntityId id = ids[row];
+				if (id == Archetype::HOLE_ID) FLUFF_UNLIKELY
 				{
-					function(GetFromTuple<TComponents>(current)...);
-					IncrementElements(current);
+					continue;
+				}
+				
+				const Archetype::IndexType groupRow = lookupGroup ? group->IndexOf(id) : row;
+				if constexpr (WITH_ENTITY)
+				{
+					function(id, GetFromColumns<TComponents>(columns, row, groupRow)...);
+				} else
+				{
+					function(GetFromColumns<TComponents>(columns, row, groupRow)...);
 				}
 			}
 		}
 		
-		/// Iterates over all components of the given types.
+		/// Splits an iteration over the given types into chunks of rows, which visit the same entities as ForeachImpl and
+		/// ForeachEntityImpl when passed to ForeachInChunk. The chunks stay valid until the world is changed structurally
+		/// \tparam WITH_ENTITY whether the iteration passes the EntityId as the first argument
 		/// \tparam TComponents Entity need to have at minimum to be iterated over
-		/// \param function to apply on them
-		template<typename ...TComponents, typename TFunc>
-		void ForeachEntityImpl(TFunc &function, internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		/// \param chunkSize maximum number of rows per chunk
+		/// \param chunks to append the chunks to
+		template<bool WITH_ENTITY, typename ...TComponents, typename TAllocator>
+		void CollectChunks(std::size_t chunkSize, std::vector<internal::QueryChunk, TAllocator> &chunks) FLUFF_MAYBE_NOEXCEPT
 		{
-			static_assert(((not std::is_pointer_v<TComponents>) && ...), "Type cannot be a pointer");
-			static_assert(std::is_invocable_v<TFunc, EntityId, TComponents...>,
-					"Function parameters do not match with given template parameters or missing an flf::EntityId as the first parameter");
-			std::vector<Archetype *> containers = CollectVectorsOf<ValueType<TComponents>...>();
+			assert(chunkSize != 0 && "Chunks need to contain at least one row");
+			assert(not (SparseStorageOf(TypeId<ValueType<TComponents>>()) || ...) && "Sparse components cannot be iterated in chunks");
 			
-			for (Archetype *container : containers)
+			const auto addChunks = [chunkSize, &chunks](Archetype &container)
 			{
-				auto current = container->template RawBeginWithEntity<std::remove_reference_t<TComponents>...>();
-				const auto ends = container->template RawEndWithEntity<std::remove_reference_t<TComponents>...>();
-				
-				while (std::get<EntityId *>(current) < std::get<EntityId *>(ends))
+				const std::size_t nRows = container.RowCount();
+				for (std::size_t beginRow = 0; beginRow < nRows; beginRow += chunkSize)
 				{
-					function(*std::get<EntityId *>(current), GetFromTuple<TComponents>(current)...);
-					IncrementElements(current);
+					chunks.push_back({&container, beginRow, std::min(beginRow + chunkSize, nRows)});
+				}
+			};
+			
+			// groups that contain all wanted types cover all of their containers
+			if constexpr (not WITH_ENTITY || sizeof...(TComponents) != 0)
+			{
+				for (Archetype *group : _groups)
+				{
+					if ((group->ContainsType(TypeId<ValueType<TComponents>>()) && ...))
+					{
+						addChunks(*group);
+					}
+				}
+			}
+			
+			for (Archetype *container : CachedVectorsOf<ValueType<TComponents>...>())
+			{
+				const Archetype *group = container->GetGroup();
+				if (group == nullptr || not (container->IsGroupedType(TypeId<ValueType<TComponents>>()) || ...) ||
+				    not (group->ContainsType(TypeId<ValueType<TComponents>>()) && ...)) FLUFF_LIKELY
+				{
+					addChunks(*container);
 				}
 			}
 		}
@@ -314,7 +2117,7 @@ namespace flf
 			std::pmr::vector<IdType> ids{infos.size(), &_tempResource};
 			for (std::size_t i = 0; i < infos.size(); ++i)
 			{
-				createdContainer->AddVector(infos[i], constructors[i], GetMemoryResource(infos[i].id));
+				createdContainer->AddType(infos[i], constructors[i], GetMemoryResource(infos[i].id));
 				ids[i] = infos[i].id;
 			}
 			
@@ -339,6 +2142,52 @@ namespace flf
 			return _vectorsMap.GetAllFromSequence<sizeof...(TComponents)>({TypeId<TComponents>() ...});
 		}
 		
+		/// Looks up all containers that contain at least the given types. The result is cached and kept up to date
+		/// when new containers are registered, so only the first lookup of a set of types allocates
+		/// \tparam TComponents the types that the containers need to contain at least
+		/// \return a reference to the cached list. Containers registered later are appended to it
+		template<typename ...TComponents>
+		const std::vector<Archetype *> &CachedVectorsOf() FLUFF_MAYBE_NOEXCEPT
+		{
+			constexpr std::array<IdType, sizeof...(TComponents)> types = SortedTypeIdList<std::remove_const_t<std::remove_reference_t<TComponents>>...>();
+			return CachedVectorsOf(types.data(), types.size());
+		}
+		
+		/// Looks up the cached list of all containers that contain at least the given types, without creating it
+		/// \param types ids of the types, sorted ascending
+		/// \param count number of types
+		/// \return a pointer to the cached list, or nullptr if these types were never iterated over
+		[[nodiscard]] const std::vector<Archetype *> *FindCachedVectorsOf(const IdType *types, std::size_t count) const FLUFF_NOEXCEPT
+		{
+			const MultiIdType multiId = internal::CombineIds(types, types + count);
+			const auto [begin, end] = _queryCaches.equal_range(multiId);
+			for (auto current = begin; current != end; ++current)
+			{
+				if (std::equal(types, types + count, current->second.types.cbegin(), current->second.types.cend()))
+				{
+					return &current->second.containers;
+				}
+			}
+			return nullptr;
+		}
+		
+		/// Looks up all containers that contain at least the given types. The result is cached and kept up to date
+		/// when new containers are registered, so only the first lookup of a set of types allocates
+		/// \param types ids of the types, sorted ascending
+		/// \param count number of types
+		/// \return a reference to the cached list. Containers registered later are appended to it
+		const std::vector<Archetype *> &CachedVectorsOf(const IdType *types, std::size_t count) FLUFF_MAYBE_NOEXCEPT
+		{
+			if (const std::vector<Archetype *> *cached = FindCachedVectorsOf(types, count)) FLUFF_LIKELY
+			{
+				return *cached;
+			}
+			
+			const MultiIdType multiId = internal::CombineIds(types, types + count);
+			QueryCache cache{std::vector<IdType>(types, types + count), _vectorsMap.GetAllFromSequence(std::vector<IdType>(types, types + count))};
+			return _queryCaches.emplace(multiId, std::move(cache))->second.containers;
+		}
+		
 		template<typename ...TComponents>
 		inline Entity CreateEntityImpl(internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT
 		{
@@ -360,6 +2209,56 @@ namespace flf
 			return Entity(vec.EmplaceBack(std::forward<TAddedComponents>(args)...), *this);
 		}
 		
+		/// Creates an entity of which at least one component is sparse. The Archetype of the other components is resolved
+		/// first, so that the entity is created in it at once instead of being moved there from the empty Archetype
+		/// \param components of the entity
+		/// \return the created entity
+		template<typename ...TComponents>
+		Entity CreateEntityWithSparse(TComponents &&...components) FLUFF_MAYBE_NOEXCEPT
+		{
+			Archetype &container = ContainerWithoutSparse(internal::Sort(internal::TypeList<TComponents...>()));
+			const Entity entity(container.EmplaceBackContained(std::move(components)...), *this);
+			
+			// the container only took the components it contains, the sparse ones are still untouched
+			const auto emplaceSparse = [this, &entity](auto &&component)
+			{
+				using TComponent = std::decay_t<decltype(component)>;
+				if (internal::SparseStorage *storage = SparseStorageOf(TypeId<TComponent>()))
+				{
+					storage->template Emplace<TComponent>(entity.Id(), std::move(component));
+				}
+			};
+			(emplaceSparse(std::move(components)), ...);
+			return entity;
+		}
+		
+		/// Looks up the Archetype containing EXACTLY the given types that are not sparse, or creates it
+		/// \tparam TComponents sorted by type id
+		/// \return a reference to that container
+		template<typename ...TComponents>
+		Archetype &ContainerWithoutSparse(internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT
+		{
+			MultiIdType signature = MultiTypeId<>();
+			((signature = SparseStorageOf(TypeId<TComponents>()) ? signature : signature xor TypeId<TComponents>()), ...);
+			if (auto found = _componentContainers.find(signature); found != _componentContainers.end())
+			{
+				return *found->second;
+			}
+			
+			std::pmr::vector<TypeInformation> tInfos{&_tempResource};
+			std::pmr::vector<internal::ConstructorVTable> constructors{&_tempResource};
+			const auto addIfDense = [this, &tInfos, &constructors](TypeInformation tInfo, internal::ConstructorVTable typeConstructors)
+			{
+				if (SparseStorageOf(tInfo.id) == nullptr)
+				{
+					tInfos.push_back(tInfo);
+					constructors.push_back(typeConstructors);
+				}
+			};
+			(addIfDense(TypeInformation::Of<TComponents>(), internal::ConstructorVTable::Of<TComponents>()), ...);
+			return CreateComponentContainerWith(tInfos, constructors, signature);
+		}
+		
 		template<typename ...TComponents>
 		inline void CreateMultipleImpl(internal::TypeList<TComponents...>, EntityId numEntities) FLUFF_MAYBE_NOEXCEPT
 		{
@@ -397,8 +2296,9 @@ namespace flf
 			} else
 			{
 				// need to create a new container for this entity
-				std::pmr::vector<TypeInformation> tInfos{source.GetTypeInfos(), &_tempResource};
-				std::pmr::vector<internal::ConstructorVTable> constructors{source.GetConstructorTable(), &_tempResource};
+				std::pmr::vector<TypeInformation> tInfos{&_tempResource};
+				std::pmr::vector<internal::ConstructorVTable> constructors{&_tempResource};
+				source.GetSignature(tInfos, constructors);
 				
 				// the vector is already sorted, we only need to insert the new data at the correct position to keep it sorted
 				constexpr std::array<TypeInformation, sizeof...(TAddedComponents)> tInfosToAdd = {
@@ -446,14 +2346,205 @@ namespace flf
 				
 				// place new ComponentVector into that location
 				createdVector = new(createdVector) Archetype(_containerResource);
-				((createdVector->AddVector<TComponents>(GetMemoryResource(TypeId<TComponents>()))), ...);
+				(createdVector->template AddType<TComponents>(GetMemoryResource(TypeId<TComponents>())), ...);
 				
 				
-				RegisterVector(createdVector, id, std::pmr::vector<IdType>({TypeId<TComponents>()...}, &_tempResource));
+				RegisterVector(createdVector, id, std::pmr::vector<IdType>(std::initializer_list<IdType>{TypeId<TComponents>()...}, &_tempResource));
 				return *createdVector;
 			}
 		}
 		
+		/// Looks up the component container containing EXACTLY the given components, or, if none is found, creates a new one
+		/// \return a reference to that container
+		template<typename ...TComponents>
+		inline Archetype &GetComponentVectorOf(internal::TypeList<TComponents...>)
+		{
+			return GetComponentVector<TComponents...>();
+		}
+		
+		/// Iterates over all Archetypes having all required and none of the excluded types
+		/// \param columnTypes types to pass a column of to function
+		/// \param nColumns number of column types
+		/// \param required sorted types the entities need to have
+		/// \param excluded types the entities may not have
+		/// \param nExcluded number of excluded types
+		/// \param hasFilters true when entities of the same group might differ in what is passed to function
+		/// \param function to call for every range
+		template<typename TAllocator, typename TFunc>
+		void ForeachColumnsImpl(const IdType *columnTypes, std::size_t nColumns, const std::vector<IdType, TAllocator> &required,
+		                        const IdType *excluded, std::size_t nExcluded, bool hasFilters, TFunc &function)
+		FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, std::size_t, const EntityId *, void *const *>)
+		{
+			static_assert(std::is_invocable_v<TFunc, std::size_t, const EntityId *, void *const *>,
+			              "Function needs the signature void(std::size_t, const EntityId *, void *const *)");
+			assert(std::none_of(columnTypes, columnTypes + nColumns, [this](IdType type) { return SparseStorageOf(type) != nullptr; }) &&
+			       "Sparse components cannot be iterated by column");
+			
+			const auto containsAllRequired = [&required](const Archetype &container)
+			{
+				return std::all_of(required.cbegin(), required.cend(), [&container](IdType type) { return container.ContainsType(type); });
+			};
+			
+			std::pmr::vector<void *> columns{nColumns, nullptr, &_tempResource};
+			std::pmr::vector<std::byte *> columnData{nColumns, nullptr, &_tempResource};
+			std::pmr::vector<std::size_t> elementSizes{nColumns, 0, &_tempResource};
+			const auto foreachRange = [&](Archetype &container)
+			{
+				FLUFF_PROFILE_VISIT(_profiler, container.Size());
+				if (container.Size() == 0)
+				{
+					return;
+				}
+				for (std::size_t i = 0; i < nColumns; ++i)
+				{
+					columnData[i] = static_cast<std::byte *>(container.ColumnData(columnTypes[i]));
+					elementSizes[i] = container.ColumnElementSize(columnTypes[i]);
+				}
+				
+				const EntityId *const ids = container.GetIds().data();
+				const auto passRows = [&](Archetype::IndexType begin, Archetype::IndexType end)
+				{
+					if (begin == end)
+					{
+						return;
+					}
+					for (std::size_t i = 0; i < nColumns; ++i)
+					{
+						columns[i] = columnData[i] ? columnData[i] + begin * elementSizes[i] : nullptr;
+					}
+					function(std::size_t(end - begin), ids + begin, static_cast<void *const *>(columns.data()));
+				};
+				
+				// holes only exist when using RemovalPolicy::KeepOrder. The rows between them are passed as separate ranges,
+				// as compacting here would move the rows of other iterations that are still running over the container
+				Archetype::IndexType row = 0;
+				for (const Archetype::IndexType hole : container.GetHoles())
+				{
+					passRows(row, hole);
+					row = hole + 1;
+				}
+				passRows(row, container.RowCount());
+			};
+			
+			// groups that contain all wanted types cover all of their containers in a single range. With filters the
+			// entities of a group might need different treatment, so they are visited through their containers instead
+			if (not hasFilters)
+			{
+				for (Archetype *group : _groups)
+				{
+					if (containsAllRequired(*group))
+					{
+						foreachRange(*group);
+					}
+				}
+			}
+			
+			const std::vector<Archetype *> &containers = CachedVectorsOf(required.data(), required.size());
+			for (std::size_t containerIndex = 0; containerIndex < containers.size(); ++containerIndex)
+			{
+				Archetype *container = containers[containerIndex];
+				if (std::any_of(excluded, excluded + nExcluded, [container](IdType type) { return container->ContainsType(type); }))
+				{
+					continue;
+				}
+				
+				const Archetype *group = container->GetGroup();
+				if (group == nullptr ||
+				    std::none_of(columnTypes, columnTypes + nColumns, [container](IdType type) { return container->IsGroupedType(type); })) FLUFF_LIKELY
+				{
+					foreachRange(*container);
+				} else if (hasFilters || not containsAllRequired(*group))
+				{
+					FLUFF_PROFILE_VISIT(_profiler, container->Size());
+					for (const EntityId id : container->GetIds())
+					{
+						if (id == Archetype::HOLE_ID)
+						{
+							continue;
+						}
+						for (std::size_t i = 0; i < nColumns; ++i)
+						{
+							columns[i] = container->GetRaw(columnTypes[i], id);
+						}
+						function(std::size_t(1), &id, static_cast<void *const *>(columns.data()));
+					}
+				}
+			}
+		}
+		
+		/// Looks up the container with exactly the types of a container of another world, or creates it
+		/// \param source container of another world
+		/// \return a reference to the container of this world
+		Archetype &ContainerWithTypesOf(const Archetype &source) FLUFF_MAYBE_NOEXCEPT
+		{
+			const MultiIdType multiId = source.GetMultiTypeId();
+			if (auto found = _componentContainers.find(multiId); found != _componentContainers.end())
+			{
+				return *found->second;
+			}
+			
+			std::pmr::vector<TypeInformation> tInfos{&_tempResource};
+			std::pmr::vector<internal::ConstructorVTable> constructors{&_tempResource};
+			source.GetSignature(tInfos, constructors);
+			assert(std::none_of(tInfos.cbegin(), tInfos.cend(), [this](TypeInformation tInfo) { return SparseStorageOf(tInfo.id); }) &&
+			       "Components that are sparse in only one of the worlds cannot be moved");
+			return CreateComponentContainerWith(tInfos, constructors, multiId);
+		}
+		
+		/// Moves the sparse components of an entity to another world
+		/// \param destination world the entity is moved to
+		/// \param id of the entity in this world
+		/// \param newId of the entity in the other world
+		void MoveSparseComponents(BasicWorld &destination, EntityId id, EntityId newId) FLUFF_MAYBE_NOEXCEPT
+		{
+			for (auto &[type, storage] : _sparseStorages)
+			{
+				if (storage.Contains(id))
+				{
+					internal::SparseStorage *destinationStorage = destination.SparseStorageOf(type);
+					assert(destinationStorage != nullptr && "Components that are sparse in only one of the worlds cannot be moved");
+					storage.MoveTo(*destinationStorage, id, newId);
+				}
+			}
+		}
+		
+		/// Looks up the component container containing EXACTLY the given registered types, or, if none is found, creates a new one
+		/// \param types ids of the registered types
+		/// \param count number of types
+		/// \return a reference to that container
+		Archetype &GetComponentVectorOf(const IdType *types, std::size_t count) FLUFF_MAYBE_NOEXCEPT
+		{
+			const MultiIdType multiId = internal::CombineIds(types, types + count);
+			if (auto found = _componentContainers.find(multiId); found != _componentContainers.end())
+			{
+				return *found->second;
+			}
+			
+			std::pmr::vector<TypeInformation> tInfos{&_tempResource};
+			std::pmr::vector<internal::ConstructorVTable> constructors{&_tempResource};
+			tInfos.reserve(count);
+			constructors.reserve(count);
+			std::pmr::vector<IdType> sortedTypes{types, types + count, &_tempResource};
+			std::sort(sortedTypes.begin(), sortedTypes.end());
+			assert(std::adjacent_find(sortedTypes.cbegin(), sortedTypes.cend()) == sortedTypes.cend() && "Types may only be given once");
+			for (const IdType type : sortedTypes)
+			{
+				assert(SparseStorageOf(type) == nullptr && "Sparse components need to be added with AddComponent");
+				const RuntimeComponent &component = RuntimeComponentOf(type);
+				tInfos.push_back(component.tInfo);
+				constructors.push_back(component.constructors);
+			}
+			return CreateComponentContainerWith(tInfos, constructors, multiId);
+		}
+		
+		/// \param type id of a registered type
+		/// \return the layout and constructors of the type
+		[[nodiscard]] const RuntimeComponent &RuntimeComponentOf(IdType type) const FLUFF_NOEXCEPT
+		{
+			assert(IsRegistered(type) && "Type was not registered with RegisterComponent");
+			return _runtimeComponents.find(type)->second;
+		}
+		
 		/// Registers the given container in this world
 		/// \param container to register
 		/// \param multiId of types contained in it
@@ -463,8 +2554,47 @@ namespace flf
 		RegisterVector(Archetype *container, MultiIdType multiId, const std::vector<IdType, TAllocator> &individualIds) FLUFF_MAYBE_NOEXCEPT
 		{
 			container->world = static_cast<internal::WorldInternal *>(this);
+			container->SetRemovalPolicy(_removalPolicy);
+			container->SetVectorContext(&_vectorContext);
+			container->SetSharedAllocation(_sharedColumnAllocation);
+			++_vectorContext.changes.archetypesCreated;
 			_componentContainers.insert({multiId, container});
 			_vectorsMap.Insert(individualIds, container);
+			for (auto &[cacheId, cache] : _queryCaches)
+			{
+				if (std::all_of(cache.types.cbegin(), cache.types.cend(), [container](IdType type) { return container->ContainsType(type); }))
+				{
+					cache.containers.push_back(container);
+				}
+			}
+			
+			for (Archetype *group : _groups)
+			{
+				const auto groupTypes = group->GetContainedTypes();
+				if (std::all_of(groupTypes.cbegin(), groupTypes.cend(), [container](TypeInformation tInfo) { return container->ContainsType(tInfo.id); }))
+				{
+					container->AttachGroup(*group);
+					break;
+				}
+			}
+		}
+		
+		/// Creates the storage of a group
+		/// \tparam TComponents sorted types of the group
+		/// \return a reference to the created group
+		template<typename ...TComponents>
+		Archetype &CreateGroupImpl(internal::TypeList<TComponents...>) FLUFF_MAYBE_NOEXCEPT
+		{
+			auto *createdGroup = (Archetype *) _containerResource.allocate(sizeof(Archetype), alignof(Archetype));
+			createdGroup = new(createdGroup) Archetype(_containerResource);
+			(createdGroup->template AddType<TComponents>(GetMemoryResource(TypeId<TComponents>())), ...);
+			
+			createdGroup->world = static_cast<internal::WorldInternal *>(this);
+			createdGroup->SetRemovalPolicy(_removalPolicy);
+			createdGroup->SetVectorContext(&_vectorContext);
+			createdGroup->SetSharedAllocation(_sharedColumnAllocation);
+			_groups.push_back(createdGroup);
+			return *createdGroup;
 		}
 	
 	private:
@@ -548,6 +2678,47 @@ namespace flf
 		{
 			return *std::get<std::remove_reference_t<T> *>(tuple);
 		}
+		
+		/// Pointer to the data of a vector that might be saved in the group of a container
+		template<typename T>
+		struct ColumnRef
+		{
+			T *data;
+			bool isGrouped;
+		};
+		
+		/// creates an internal::TypeList with all nonempty types of a parameter pack
+		template<typename ...Ts> using NonEmptyTypeList = decltype(internal::AllNonEmptyTypes(internal::TypeList<Ts...>()));
+		
+		/// \tparam Ts non empty types to get
+		/// \param container to get the vectors from
+		/// \return a tuple with a ColumnRef for each type
+		template<typename ...Ts>
+		static std::tuple<ColumnRef<Ts>...> GetColumns(Archetype &container, internal::TypeList<Ts...>) FLUFF_NOEXCEPT
+		{
+			return {ColumnRef<Ts>{std::launder(reinterpret_cast<Ts *>(container.template GetVector<ValueType<Ts>>().Data())),
+			                      container.IsGroupedType(TypeId<ValueType<Ts>>())}...};
+		}
+		
+		/// Gets an element from a tuple of ColumnRefs or returns a new element by value if IsEmpty<T> evaluates to true
+		/// \tparam T Type to get
+		/// \param columns to get the element from
+		/// \param row of the element in its container
+		/// \param groupRow of the element in the group of its container
+		/// \return A reference to the element
+		template<typename T, typename TColumns>
+		static constexpr decltype(auto) GetFromColumns(TColumns &columns, Archetype::IndexType row, Archetype::IndexType groupRow) FLUFF_NOEXCEPT
+		{
+			if constexpr (internal::IsEmpty<std::remove_reference_t<T>>)
+			{
+				static_assert(not std::is_reference_v<T>, "Has to get empty type by value");
+				return ValueType<T>();
+			} else
+			{
+				const ColumnRef<std::remove_reference_t<T>> column = std::get<ColumnRef<std::remove_reference_t<T>>>(columns);
+				return static_cast<std::remove_reference_t<T> &>(column.data[column.isGrouped ? groupRow : row]);
+			}
+		}
 	
 	private:
 		/// Used to handle component vector allocations (and deallocations)
@@ -559,6 +2730,38 @@ namespace flf
 		Map<MultiIdType, Archetype *> _componentContainers{};
 		/// maps a sequence of component types to component containers that contain those
 		internal::KeySequenceTree<IdType, Archetype *> _vectorsMap{_tempResource};
+		
+		/// used for all Archetypes of this world
+		RemovalPolicy _removalPolicy = RemovalPolicy::SwapWithLast;
+		
+		/// whether the Archetypes of this world save all their vectors in a single allocation
+		bool _sharedColumnAllocation = false;
+		
+#ifdef FLUFF_PROFILE
+		/// records every Foreach, ForeachEntity and ForeachColumns
+		Profiler _profiler{};
+#endif
+		
+		/// dedicated storages of the declared groups
+		std::vector<Archetype *> _groups{};
+		
+		/// all types declared with DeclareDoubleBuffered
+		std::vector<IdType> _doubleBufferedTypes{};
+		
+		/// reused by Sort to reorder the vectors of every Archetype, so sorting every frame does not allocate
+		std::pmr::vector<std::max_align_t> _sortBuffer{&_tempResource};
+		
+		/// Resources are indexed by internal::ResourceIndex<T>(), empty slots have data set to nullptr
+		std::vector<ResourceSlot> _worldResources{};
+		
+		/// results of CachedVectorsOf, keyed by the combined id of the types. Different sets of types may share the same key
+		std::unordered_multimap<MultiIdType, QueryCache> _queryCaches{};
+		
+		/// all types registered with RegisterComponent
+		Map<IdType, RuntimeComponent> _runtimeComponents{};
+		
+		/// values of all registered prefabs, indexed by Prefab::Index()
+		std::vector<std::unique_ptr<internal::PrefabRow>> _prefabs{};
 	};
 	
 	using World = BasicWorld<std::pmr::unsynchronized_pool_resource>;
@@ -571,6 +2774,11 @@ namespace flf
 			return nullptr;
 		}
 		
+		if (auto *storage = _world->SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+		{
+			return storage->Contains(Id()) ? &storage->template Get<TComponent>(Id()) : nullptr;
+		}
+		
 		Archetype &cont = _world->ContainerOf(Id());
 		if (cont.ContainsId(Id()))
 		{
@@ -589,6 +2797,11 @@ namespace flf
 			return nullptr;
 		}
 		
+		if (auto *storage = _world->SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+		{
+			return storage->Contains(Id()) ? &storage->template Get<TComponent>(Id()) : nullptr;
+		}
+		
 		Archetype &cont = _world->ContainerOf(Id());
 		if (cont.ContainsId(Id()))
 		{
@@ -606,7 +2819,25 @@ namespace flf
 			return;
 		}
 		
+		internal::Hierarchy &hierarchy = _world->GetHierarchy();
+		if (hierarchy.Contains(Id())) FLUFF_UNLIKELY
+		{
+			// destroying a parent also destroys all of its descendants. They are removed from the hierarchy leaves first,
+			// so that no removal has to update the depths of a subtree
+			std::pmr::vector<EntityId> descendants{&_world->GetTempResource()};
+			hierarchy.CollectDescendants(Id(), descendants);
+			for (auto descendant = descendants.crbegin(); descendant != descendants.crend(); ++descendant)
+			{
+				hierarchy.Remove(*descendant);
+				Archetype &descendantContainer = _world->ContainerOf(*descendant);
+				_world->RemoveSparseComponents(*descendant);
+				descendantContainer.Remove(*descendant);
+			}
+			hierarchy.Remove(Id());
+		}
+		
 		Archetype &cont = _world->ContainerOf(Id());
+		_world->RemoveSparseComponents(Id());
 		cont.Remove(Id());
 		_world = nullptr; // just to be safe
 	}
@@ -619,6 +2850,11 @@ namespace flf
 			return false;
 		}
 		
+		if (const auto *storage = _world->SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+		{
+			return storage->Contains(Id());
+		}
+		
 		const Archetype &cont = _world->ContainerOf(Id());
 		return cont.ContainsType(TypeId<TComponent>()) && cont.ContainsId(Id());
 	}
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <atomic>
 #include <memory_resource>
 #include <utility>
+#include <unordered_map>
 #include "Keywords.h"
 #include "SparseSet.h"
 #include "Entity.h"
+#include "SparseStorage.h"
+#include "Hierarchy.h"
 
 namespace flf
 {
@@ -16,6 +20,11 @@ namespace flf::internal
 	class WorldInternal
 	{
 	public:
+		WorldInternal() FLUFF_NOEXCEPT
+		{
+			_entityToContainer.SetResizeCounter(&_vectorContext.changes.sparseResizes);
+		}
+		
 		[[nodiscard]] bool Contains(EntityId id) const FLUFF_NOEXCEPT
 		{
 			return _entityToContainer.Contains(id);
@@ -31,12 +40,19 @@ namespace flf::internal
 			return *_entityToContainer[id];
 		}
 		
+		/// Starts loading the entry of ContainerOf into the cache
+		/// \param id of an entity of this world
+		inline void PrefetchContainerOf(EntityId id) const FLUFF_NOEXCEPT
+		{
+			_entityToContainer.Prefetch(id);
+		}
+		
 		inline std::pair<EntityId, EntityId> GetNextIndicesRange(EntityId n, Archetype &owner)
 		{
 			// TODO: This causes bad alloc for large sizes, but the single one does not. why?
-			auto beginIndex = _nextFreeIndex;
-			auto endIndex = _nextFreeIndex + n;
-			_nextFreeIndex = endIndex + 1;
+			auto beginIndex = PeekNextFreeIndex();
+			auto endIndex = beginIndex + n;
+			_nextFreeIndex.store(endIndex + 1, std::memory_order_relaxed);
 			
 			_entityToContainer.AddRange(beginIndex, endIndex, &owner);
 			
@@ -48,7 +64,7 @@ namespace flf::internal
 		/// \return the a free unique id for an entity in this world
 		[[nodiscard]] inline EntityId PeekNextFreeIndex() const FLUFF_MAYBE_NOEXCEPT
 		{
-			return _nextFreeIndex;
+			return _nextFreeIndex.load(std::memory_order_relaxed);
 		}
 		
 		/// Creates a new unique id for an entity
@@ -56,26 +72,107 @@ namespace flf::internal
 		/// \return the a free unique id for an entity in this world
 		[[nodiscard]] inline EntityId TakeNextFreeIndex(Archetype &owner) FLUFF_MAYBE_NOEXCEPT
 		{
-			auto index = _nextFreeIndex;
+			auto index = PeekNextFreeIndex();
 			// TODO: This is a performance bottleneck. Can we make this more efficient than taking much of the time of creating many entities?
 			_entityToContainer.AddEntry(index, &owner);
 			
-			++_nextFreeIndex;
+			// only ReserveIds may be called concurrently, and never together with this, so no atomic increment is needed
+			_nextFreeIndex.store(index + 1, std::memory_order_relaxed);
 			return index;
 		}
 		
+		/// Reserves ids for entities that are registered later with RegisterReservedId. May be called from multiple
+		/// threads at once, but not while the world is changed structurally
+		/// \param n number of ids to reserve
+		/// \return the first of n consecutive ids
+		[[nodiscard]] inline EntityId ReserveIds(EntityId n) FLUFF_NOEXCEPT
+		{
+			return _nextFreeIndex.fetch_add(n, std::memory_order_relaxed);
+		}
+		
+		/// Associates an id taken from ReserveIds with the container of its entity
+		/// \param id reserved id
+		/// \param owner of the entity
+		inline void RegisterReservedId(EntityId id, Archetype &owner) FLUFF_MAYBE_NOEXCEPT
+		{
+			_entityToContainer.AddEntry(id, &owner);
+		}
+		
 		inline void AssociateIdWith(EntityId id, Archetype &container) FLUFF_NOEXCEPT
 		{
 			_entityToContainer.SetEntry(id, &container);
 		}
+		
+		/// \param type id of a component type
+		/// \return the storage of that type if it was declared sparse, nullptr otherwise
+		[[nodiscard]] inline SparseStorage *SparseStorageOf(IdType type) FLUFF_NOEXCEPT
+		{
+			if (_sparseStorages.empty()) FLUFF_LIKELY
+			{
+				return nullptr;
+			}
+			
+			auto found = _sparseStorages.find(type);
+			return found != _sparseStorages.end() ? &found->second : nullptr;
+		}
+		
+		/// \param type id of a component type
+		/// \return the storage of that type if it was declared sparse, nullptr otherwise
+		[[nodiscard]] inline const SparseStorage *SparseStorageOf(IdType type) const FLUFF_NOEXCEPT
+		{
+			return const_cast<WorldInternal *>(this)->SparseStorageOf(type);
+		}
+		
+		/// \return the parent/child relationships of the entities of this world
+		[[nodiscard]] inline Hierarchy &GetHierarchy() FLUFF_NOEXCEPT
+		{
+			return _hierarchy;
+		}
+		
+		/// \return the parent/child relationships of the entities of this world
+		[[nodiscard]] inline const Hierarchy &GetHierarchy() const FLUFF_NOEXCEPT
+		{
+			return _hierarchy;
+		}
+		
+		/// \return the resource for small, temporary allocations
+		[[nodiscard]] inline std::pmr::memory_resource &GetTempResource() FLUFF_NOEXCEPT
+		{
+			return _tempResource;
+		}
+		
+		/// Removes the sparse stored components of an entity that is destroyed
+		/// \param id of the destroyed entity
+		inline void RemoveSparseComponents(EntityId id) FLUFF_NOEXCEPT
+		{
+			for (auto &storage : _sparseStorages)
+			{
+				storage.second.Remove(id);
+			}
+		}
+	
+		/// \return the number of bytes reserved for the lookup from entity ids to their Archetypes
+		[[nodiscard]] inline std::size_t EntityLookupByteCapacity() const FLUFF_NOEXCEPT
+		{
+			return _entityToContainer.ByteCapacity();
+		}
 	
 	protected:
-		EntityId _nextFreeIndex = 0;
+		/// atomic, so that EntityStages on different threads can reserve ids at the same time
+		std::atomic<EntityId> _nextFreeIndex{0};
 		
 		std::pmr::monotonic_buffer_resource _sparseMemory{8192};
 		/// Used for small, temporary allocations
 		std::pmr::unsynchronized_pool_resource _tempResource{{2, 1024}};
 		
+		/// growth policy and memory accounting of all component vectors of this world
+		VectorContext _vectorContext{};
+		
 		internal::SparseSet<Archetype *, EntityId> _entityToContainer{_sparseMemory};
+		
+		/// components that are saved outside of the Archetypes
+		std::unordered_map<IdType, SparseStorage> _sparseStorages{};
+		
+		Hierarchy _hierarchy{_sparseMemory};
 	};
 }
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cassert>
+#include <type_traits>
+#include "Keywords.h"
+#include "TypeId.h"
+#include "TypeList.h"
+#include "Entity.h"
+#include "World.h"
+
+namespace flf
+{
+	/// A read-only view of a world. Its queries never change the world, not even the query caches that Foreach
+	/// updates, so any number of threads may query the same world through views at the same time. No thread may change
+	/// the world while a view is used, e.g. views are used between two sync points of the frame. Iterating a view over types
+	/// that the world itself has never iterated over searches all Archetypes, so iterate the world once first where this matters
+	/// \tparam TMemResource memory resource of the world
+	template<typename TMemResource = std::pmr::unsynchronized_pool_resource>
+	class BasicWorldView
+	{
+	public:
+		/// \param world to read from. Has to outlive the view
+		explicit BasicWorldView(const BasicWorld<TMemResource> &world) FLUFF_NOEXCEPT: _world(&world)
+		{
+		}
+		
+		/// \param id of an entity
+		/// \return true if the entity was created in the world
+		[[nodiscard]] inline bool Contains(EntityId id) const FLUFF_NOEXCEPT
+		{
+			return _world->Contains(id);
+		}
+		
+		/// \tparam TComponent type to check for
+		/// \param id of an entity of the world
+		/// \return true if the entity has a component of the given type
+		template<typename TComponent>
+		[[nodiscard]] bool Has(EntityId id) const FLUFF_NOEXCEPT
+		{
+			assert(Contains(id) && "Entity does not belong to this World");
+			if (const internal::SparseStorage *storage = _world->SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+			{
+				return storage->Contains(id);
+			}
+			return _world->ContainerOf(id).template Contains<TComponent>(id);
+		}
+		
+		/// Gets the component of a given entity
+		/// \tparam TComponent type to get
+		/// \param id of an entity that owns the wanted component
+		/// \return a const reference to the component
+		template<typename TComponent>
+		[[nodiscard]] const TComponent &Get(EntityId id) const FLUFF_NOEXCEPT
+		{
+			static_assert((std::is_same_v<std::decay_t<TComponent>, TComponent>), "Type cannot be reference or pointer");
+			assert(Contains(id) && "Entity does not belong to this World");
+			
+			if (const internal::SparseStorage *storage = _world->SparseStorageOf(TypeId<TComponent>())) FLUFF_UNLIKELY
+			{
+				return storage->template Get<TComponent>(id);
+			}
+			return _world->ContainerOf(id).template Get<TComponent>(id);
+		}
+		
+		/// Gets the component of a given entity, if it has one
+		/// \tparam TComponent type to get
+		/// \param id of an entity
+		/// \return a pointer to the component, or nullptr if the entity does not exist or has no such component
+		template<typename TComponent>
+		[[nodiscard]] const TComponent *TryGet(EntityId id) const FLUFF_NOEXCEPT
+		{
+			if (not Contains(id) || not Has<TComponent>(id))
+			{
+				return nullptr;
+			}
+			return &Get<TComponent>(id);
+		}
+		
+		/// Iterates over all components of the given types. The parameters of the function have to be const references or
+		/// values, resources cannot be used
+		/// \param function to apply on them
+		template<typename TFunc>
+		void Foreach(TFunc &&function) const FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			using Arguments = decltype(internal::CallableArgList(function));
+			static_assert(not internal::ContainsRes(Arguments()), "Resources cannot be used through a view");
+			_world->template ForeachReadOnlyImpl<false>(function, Arguments());
+		}
+		
+		/// Iterates over all components of the given types, passing the id of the entity first. The other parameters of
+		/// the function have to be const references or values, resources cannot be used
+		/// \param function to apply on them
+		template<typename TFunc>
+		void ForeachEntity(TFunc &&function) const FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc>)
+		{
+			using Arguments = decltype(internal::RemoveFirst(internal::CallableArgList(function)));
+			static_assert(not internal::ContainsRes(Arguments()), "Resources cannot be used through a view");
+			_world->template ForeachReadOnlyImpl<true>(function, Arguments());
+		}
+
+		/// Gets the value of a double buffered component at the last BasicWorld::SwapBuffers
+		/// \tparam TComponent double buffered type
+		/// \param id of an entity that had the component at the last swap
+		/// \return a const reference to the previous value
+		template<typename TComponent>
+		[[nodiscard]] const TComponent &GetPrevious(EntityId id) const FLUFF_NOEXCEPT
+		{
+			return _world->template GetPrevious<TComponent>(id);
+		}
+
+		/// Iterates over the values of a double buffered type at the last BasicWorld::SwapBuffers. Systems may write the
+		/// current values of the type at the same time
+		/// \tparam TComponent double buffered type
+		/// \param function with signature void(EntityId, const TComponent &)
+		template<typename TComponent, typename TFunc>
+		void ForeachPrevious(TFunc &&function) const FLUFF_MAYBE_NOEXCEPT(std::is_nothrow_invocable_v<TFunc, EntityId, const TComponent &>)
+		{
+			_world->template ForeachPrevious<TComponent>(std::forward<TFunc>(function));
+		}
+
+	private:
+		const BasicWorld<TMemResource> *_world;
+	};
+	
+	using WorldView = BasicWorldView<std::pmr::unsynchronized_pool_resource>;
+}
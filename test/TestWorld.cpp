@@ -1,6 +1,15 @@
 #include "doctest.h"
 
 #include <FluffECS/World.h>
+#include <FluffECS/WorldView.h>
+#include <FluffECS/SystemScheduler.h>
+#include <FluffECS/HugePageResource.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <thread>
 
 struct Vector3
 {
@@ -374,4 +383,1756 @@ TEST_CASE("Object System")
 				CHECK_EQ(pos.x, float(counter) *2);
 				counter++;
 			});
-}
\ No newline at end of file
+}
+
+struct LifetimeCounter
+{
+	static inline int nAlive = 0;
+	
+	int value = 0;
+	
+	LifetimeCounter()
+	{
+		++nAlive;
+	}
+	
+	explicit LifetimeCounter(int value)
+			: value(value)
+	{
+		++nAlive;
+	}
+	
+	LifetimeCounter(const LifetimeCounter &other)
+			: value(other.value)
+	{
+		++nAlive;
+	}
+	
+	~LifetimeCounter()
+	{
+		--nAlive;
+	}
+};
+
+TEST_CASE("World DestroyAll")
+{
+	const int nAliveBefore = LifetimeCounter::nAlive;
+	flf::World myWorld{};
+	myWorld.CreateMultiple<Position, Velocity>(16);
+	myWorld.CreateMultiple<Position>(8);
+	flf::Entity survivor = myWorld.CreateEntity(Velocity{1, 2, 3});
+	flf::Entity destroyed = myWorld.CreateEntity(Position{}, LifetimeCounter{});
+	
+	myWorld.DestroyAll<Position>();
+	CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore);
+	CHECK(destroyed.IsDead());
+	CHECK_FALSE(survivor.IsDead());
+	
+	std::size_t nPositions = 0;
+	myWorld.Foreach([&](Position) { ++nPositions; });
+	CHECK_EQ(nPositions, 0);
+	
+	std::size_t nVelocities = 0;
+	myWorld.Foreach([&](Velocity) { ++nVelocities; });
+	CHECK_EQ(nVelocities, 1);
+	CHECK_EQ(survivor.Get<Velocity>()->dz, 3);
+}
+
+TEST_CASE("World Destroy multiple")
+{
+	const int nAliveBefore = LifetimeCounter::nAlive;
+	flf::World myWorld{};
+	std::vector<flf::Entity> toDestroy{};
+	std::vector<flf::Entity> toKeep{};
+	for (int i = 0; i < 64; ++i)
+	{
+		flf::Entity created = i % 2 == 0
+		                      ? myWorld.CreateEntity(LifetimeCounter{i}, Vector3{i, i, i})
+		                      : myWorld.CreateEntity(LifetimeCounter{i});
+		(i % 3 == 0 ? toDestroy : toKeep).push_back(created);
+	}
+	// duplicates and dead entities are ignored
+	toDestroy.push_back(toDestroy.front());
+	
+	myWorld.Destroy(toDestroy);
+	CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 42);
+	
+	for (flf::Entity entity : toDestroy)
+	{
+		CHECK(entity.IsDead());
+	}
+	for (flf::Entity entity : toKeep)
+	{
+		REQUIRE_FALSE(entity.IsDead());
+		CHECK_EQ(entity.Get<LifetimeCounter>()->value, int(entity.Id()));
+	}
+	
+	// the remaining entities keep their relative order
+	int previousValue = -1;
+	myWorld.Foreach([&](const LifetimeCounter &counter, Vector3 vec)
+	                {
+		                CHECK_EQ(counter.value, vec.x);
+		                CHECK_GT(counter.value, previousValue);
+		                previousValue = counter.value;
+	                });
+}
+
+TEST_CASE("World RemovalPolicy KeepOrder")
+{
+	flf::World myWorld{};
+	myWorld.SetRemovalPolicy(flf::RemovalPolicy::KeepOrder);
+	
+	std::vector<flf::Entity> createdEntities{};
+	for (int i = 0; i < 32; ++i)
+	{
+		createdEntities.push_back(myWorld.CreateEntity(int(i), Quaternion{}));
+	}
+	
+	createdEntities[0].Destroy();
+	createdEntities[5].Destroy();
+	createdEntities[6].Destroy();
+	myWorld.RemoveComponent<Quaternion>(createdEntities[20]);
+	myWorld.Destroy(&createdEntities[10], 2);
+	
+	auto checkOrder = [&]()
+	{
+		std::vector<int> visited{};
+		myWorld.Foreach([&](int val, Quaternion) { visited.push_back(val); });
+		REQUIRE_EQ(visited.size(), 26);
+		CHECK(std::is_sorted(visited.cbegin(), visited.cend()));
+		CHECK(std::find(visited.cbegin(), visited.cend(), 5) == visited.cend());
+		CHECK(std::find(visited.cbegin(), visited.cend(), 20) == visited.cend());
+		
+		std::size_t nVisited = 0;
+		myWorld.ForeachEntity([&](flf::EntityId id, int val, Quaternion)
+		                      {
+			                      CHECK_EQ(createdEntities[val].Id(), id);
+			                      ++nVisited;
+		                      });
+		CHECK_EQ(nVisited, 26);
+	};
+	
+	checkOrder();
+	CHECK(createdEntities[5].IsDead());
+	CHECK_EQ(*createdEntities[21].Get<int>(), 21);
+	
+	myWorld.Compact();
+	checkOrder();
+	CHECK_EQ(*createdEntities[21].Get<int>(), 21);
+	CHECK_EQ(*createdEntities[20].Get<int>(), 20);
+}
+
+TEST_CASE_TEMPLATE("World Sort", Mode, std::integral_constant<flf::SortMode, flf::SortMode::Full>,
+                   std::integral_constant<flf::SortMode, flf::SortMode::Incremental>)
+{
+	flf::World myWorld{};
+	
+	std::vector<flf::Entity> createdEntities{};
+	for (int i = 0; i < 64; ++i)
+	{
+		const int key = (i * 37) % 64;
+		if (i % 2 == 0)
+		{
+			createdEntities.push_back(myWorld.CreateEntity(int(key), LifetimeCounter{key}));
+		} else
+		{
+			createdEntities.push_back(myWorld.CreateEntity(int(key), LifetimeCounter{key}, Quaternion{}));
+		}
+	}
+	const int nAliveBefore = LifetimeCounter::nAlive;
+	
+	myWorld.Sort<int>([](int lhs, int rhs) { return lhs > rhs; }, Mode::value);
+	CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore);
+	
+	int previousValue = std::numeric_limits<int>::max();
+	myWorld.Foreach([&](int val, const LifetimeCounter &counter, Quaternion)
+	                {
+		                CHECK_EQ(val, counter.value);
+		                CHECK_LT(val, previousValue);
+		                previousValue = val;
+	                });
+	
+	for (std::size_t i = 0; i < createdEntities.size(); ++i)
+	{
+		CHECK_EQ(*createdEntities[i].Get<int>(), (int(i) * 37) % 64);
+		CHECK_EQ(createdEntities[i].Get<LifetimeCounter>()->value, (int(i) * 37) % 64);
+	}
+	
+	// sorting an already sorted world keeps everything in place
+	std::vector<flf::EntityId> sortedIds{};
+	myWorld.ForeachEntity([&](flf::EntityId id, int) { sortedIds.push_back(id); });
+	myWorld.Sort<int>([](int lhs, int rhs) { return lhs > rhs; }, flf::SortMode::Incremental);
+	std::size_t index = 0;
+	myWorld.ForeachEntity([&](flf::EntityId id, int) { CHECK_EQ(sortedIds[index++], id); });
+	
+	// the vectors are reordered in place, they keep their allocations
+	std::vector<const int *> addresses{};
+	myWorld.Foreach([&](const int &val) { addresses.push_back(&val); });
+	myWorld.Sort<int>([](int lhs, int rhs) { return lhs < rhs; }, Mode::value);
+	std::size_t row = 0;
+	myWorld.Foreach([&](const int &val) { CHECK_EQ(addresses[row++], &val); });
+	CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore);
+	for (std::size_t i = 0; i < createdEntities.size(); ++i)
+	{
+		CHECK_EQ(createdEntities[i].Get<LifetimeCounter>()->value, (int(i) * 37) % 64);
+	}
+}
+
+struct RedTag
+{
+};
+
+struct BlueTag
+{
+};
+
+TEST_CASE("World DeclareGroup")
+{
+	flf::World myWorld{};
+	
+	// entities created before declaring the group are moved into it
+	std::vector<flf::Entity> createdEntities{};
+	for (int i = 0; i < 8; ++i)
+	{
+		createdEntities.push_back(myWorld.CreateEntity(Position{float(i), 0, 0}, Velocity{1, 0, 0}, int(i)));
+	}
+	myWorld.DeclareGroup<Position, Velocity>();
+	for (int i = 8; i < 16; ++i)
+	{
+		createdEntities.push_back(myWorld.CreateEntity(Position{float(i), 0, 0}, Velocity{1, 0, 0}, RedTag{}));
+	}
+	for (int i = 16; i < 24; ++i)
+	{
+		createdEntities.push_back(myWorld.CreateEntity(Position{float(i), 0, 0}, Velocity{1, 0, 0}, BlueTag{}, LifetimeCounter{i}));
+	}
+	
+	std::size_t nVisited = 0;
+	myWorld.Foreach([&](Position &pos, const Velocity &vel)
+	                {
+		                pos.x += vel.dx;
+		                ++nVisited;
+	                });
+	CHECK_EQ(nVisited, 24);
+	for (std::size_t i = 0; i < createdEntities.size(); ++i)
+	{
+		CHECK_EQ(createdEntities[i].Get<Position>()->x, float(i + 1));
+	}
+	
+	// mixed queries look up the grouped components
+	nVisited = 0;
+	myWorld.ForeachEntity([&](flf::EntityId id, const Position &pos, const LifetimeCounter &counter)
+	                      {
+		                      CHECK_EQ(pos.x, float(counter.value + 1));
+		                      CHECK_EQ(createdEntities[std::size_t(counter.value)].Id(), id);
+		                      ++nVisited;
+	                      });
+	CHECK_EQ(nVisited, 8);
+	
+	nVisited = 0;
+	myWorld.Foreach([&](const Velocity &, int val)
+	                {
+		                CHECK_LT(val, 8);
+		                ++nVisited;
+	                });
+	CHECK_EQ(nVisited, 8);
+	
+	// leaving and rejoining the group
+	myWorld.RemoveComponent<Velocity>(createdEntities[3]);
+	myWorld.RemoveComponent<Velocity>(createdEntities[20]);
+	CHECK_EQ(createdEntities[3].Get<Position>()->x, 4.f);
+	CHECK_EQ(createdEntities[20].Get<LifetimeCounter>()->value, 20);
+	myWorld.AddComponent(createdEntities[20], Velocity{2, 0, 0});
+	CHECK_EQ(createdEntities[20].Get<Position>()->x, 21.f);
+	CHECK_EQ(createdEntities[20].Get<Velocity>()->dx, 2.f);
+	
+	createdEntities[10].Destroy();
+	myWorld.DestroyAll<BlueTag>();
+	
+	nVisited = 0;
+	myWorld.ForeachEntity([&](flf::EntityId id, const Position &pos, Velocity)
+	                      {
+		                      CHECK_EQ(createdEntities[std::size_t(pos.x) - 1].Id(), id);
+		                      ++nVisited;
+	                      });
+	CHECK_EQ(nVisited, 14);
+	CHECK_EQ(createdEntities[12].Get<Position>()->x, 13.f);
+	CHECK_EQ(createdEntities[7].Get<Velocity>()->dx, 1.f);
+}
+
+struct Selected
+{
+	int frame = 0;
+};
+
+TEST_CASE("World DeclareSparse")
+{
+	const auto aliveBefore = LifetimeCounter::nAlive;
+	{
+		flf::World myWorld{};
+		myWorld.DeclareSparse<Selected>();
+		myWorld.DeclareSparse<LifetimeCounter>();
+		CHECK(myWorld.IsSparse<Selected>());
+		CHECK_FALSE(myWorld.IsSparse<Position>());
+		
+		std::vector<flf::Entity> createdEntities{};
+		for (int i = 0; i < 16; ++i)
+		{
+			createdEntities.push_back(myWorld.CreateEntity(Position{float(i), 0, 0}, int(i)));
+		}
+		createdEntities.push_back(myWorld.CreateEntity(Position{16, 0, 0}, Selected{16}));
+		
+		// entities with sparse components are created in the Archetype of their other components right away
+		myWorld.ResetStructuralChangeStats();
+		flf::Entity mixed = myWorld.CreateEntity(Selected{20}, Position{20, 0, 0}, RedTag{}, LifetimeCounter{20});
+		flf::Entity defaulted = myWorld.CreateEntity<Selected, Position>();
+		CHECK_EQ(myWorld.GetStructuralChangeStats().entitiesMoved, 0);
+		CHECK_EQ(mixed.Get<Position>()->x, 20.f);
+		CHECK(mixed.Has<RedTag>());
+		CHECK_EQ(mixed.Get<Selected>()->frame, 20);
+		CHECK_EQ(mixed.Get<LifetimeCounter>()->value, 20);
+		CHECK_EQ(defaulted.Get<Selected>()->frame, 0);
+		CHECK(defaulted.Has<Position>());
+		mixed.Destroy();
+		defaulted.Destroy();
+		
+		// toggling a sparse component does not move the entity to another Archetype
+		Position *const position = createdEntities[3].Get<Position>();
+		myWorld.AddComponent(createdEntities[3], Selected{3});
+		myWorld.AddComponent(createdEntities[5], Selected{5}, LifetimeCounter{5});
+		myWorld.AddComponent(createdEntities[7], Selected{7});
+		CHECK_EQ(createdEntities[3].Get<Position>(), position);
+		CHECK(createdEntities[3].Has<Selected>());
+		CHECK_FALSE(createdEntities[4].Has<Selected>());
+		CHECK_EQ(createdEntities[4].Get<Selected>(), nullptr);
+		CHECK_EQ(myWorld.Get<Selected>(createdEntities[7]).frame, 7);
+		
+		myWorld.RemoveComponent<Selected>(createdEntities[3]);
+		CHECK_FALSE(createdEntities[3].Has<Selected>());
+		CHECK_EQ(createdEntities[7].Get<Selected>()->frame, 7);
+		
+		// joining sparse and archetype components
+		std::vector<int> visited{};
+		myWorld.Foreach([&](const Position &pos, Selected &selected)
+		                {
+			                CHECK_EQ(pos.x, float(selected.frame));
+			                visited.push_back(selected.frame);
+		                });
+		std::sort(visited.begin(), visited.end());
+		CHECK_EQ(visited, std::vector<int>{5, 7, 16});
+		
+		std::size_t nVisited = 0;
+		myWorld.ForeachEntity([&](flf::EntityId id, int val, const Selected &, const LifetimeCounter &counter)
+		                      {
+			                      CHECK_EQ(createdEntities[5].Id(), id);
+			                      CHECK_EQ(val, 5);
+			                      CHECK_EQ(counter.value, 5);
+			                      ++nVisited;
+		                      });
+		CHECK_EQ(nVisited, 1);
+		
+		// destroying entities removes their sparse components
+		createdEntities[7].Destroy();
+		myWorld.DestroyAll<LifetimeCounter>();
+		CHECK(createdEntities[5].IsDead());
+		CHECK_EQ(LifetimeCounter::nAlive, aliveBefore);
+		
+		nVisited = 0;
+		myWorld.Foreach([&](Selected) { ++nVisited; });
+		CHECK_EQ(nVisited, 1);
+		
+		myWorld.AddComponent(createdEntities[0], LifetimeCounter{0});
+	}
+	CHECK_EQ(LifetimeCounter::nAlive, aliveBefore);
+}
+
+TEST_CASE("SparseSet keeps the entries of larger ids")
+{
+	flf::internal::SparseSet<std::size_t, flf::EntityId> set{*std::pmr::new_delete_resource()};
+	set.AddEntry(10, 1);
+	set.AddEntry(3, 2);
+	CHECK(set.Contains(10));
+	CHECK_EQ(set[10], 1);
+	CHECK_EQ(set[3], 2);
+	CHECK_FALSE(set.Contains(4));
+	
+	// the later entity enters the Archetype of Position and Velocity first
+	flf::World myWorld{};
+	const flf::Entity first = myWorld.CreateEntity(Position{1, 0, 0});
+	const flf::Entity second = myWorld.CreateEntity(Position{2, 0, 0});
+	myWorld.AddComponent(second, Velocity{2, 0, 0});
+	myWorld.AddComponent(first, Velocity{1, 0, 0});
+	CHECK_EQ(first.Get<Velocity>()->dx, 1);
+	CHECK_EQ(second.Get<Velocity>()->dx, 2);
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World tags have no vector")
+{
+	std::pmr::unsynchronized_pool_resource resource{};
+	flf::Archetype archetype{resource};
+	const flf::Archetype &constArchetype = archetype;
+	archetype.AddType<Empty>(resource);
+	archetype.AddType<Position>(resource);
+	CHECK_EQ(constArchetype.GetAllVectors().size(), 1);
+	CHECK_EQ(archetype.TypeCount(), 2);
+	CHECK(archetype.ContainsType(flf::TypeId<Empty>()));
+	CHECK(archetype.IsTagType(flf::TypeId<Empty>()));
+	CHECK_EQ(archetype.GetMultiTypeId(), flf::MultiTypeId<Empty, Position>());
+	
+	flf::World myWorld{};
+	std::vector<flf::Entity> createdEntities{};
+	for (int i = 0; i < 8; ++i)
+	{
+		createdEntities.push_back(myWorld.CreateEntity(Position{float(i), 0, 0}, RedTag{}));
+	}
+	
+	myWorld.AddComponent<BlueTag>(createdEntities[2]);
+	myWorld.RemoveComponent<RedTag>(createdEntities[3]);
+	CHECK(createdEntities[2].Has<BlueTag>());
+	CHECK(createdEntities[2].Has<RedTag>());
+	CHECK_FALSE(createdEntities[3].Has<RedTag>());
+	CHECK_EQ(createdEntities[2].Get<Position>()->x, 2.f);
+	CHECK_EQ(createdEntities[3].Get<Position>()->x, 3.f);
+	
+	std::size_t nVisited = 0;
+	myWorld.Foreach([&](const Position &, RedTag) { ++nVisited; });
+	CHECK_EQ(nVisited, 7);
+	
+	nVisited = 0;
+	myWorld.ForeachEntity([&](flf::EntityId id, const Position &, BlueTag, RedTag)
+	                      {
+		                      CHECK_EQ(id, createdEntities[2].Id());
+		                      ++nVisited;
+	                      });
+	CHECK_EQ(nVisited, 1);
+}
+
+struct Time
+{
+	float deltaTime = 0;
+};
+
+TEST_CASE("World Resources")
+{
+	flf::World myWorld{};
+	CHECK_FALSE(myWorld.HasResource<Time>());
+	myWorld.SetResource<Time>(Time{0.5f});
+	REQUIRE(myWorld.HasResource<Time>());
+	CHECK_EQ(myWorld.Resource<Time>().deltaTime, 0.5f);
+	
+	for (int i = 0; i < 8; ++i)
+	{
+		myWorld.CreateEntity(Position{float(i), 0, 0}, Velocity{2, 0, 0}, RedTag{});
+	}
+	
+	myWorld.Foreach([](Position &pos, flf::Res<const Time> time, const Velocity &vel)
+	                {
+		                pos.x += vel.dx * time->deltaTime;
+	                });
+	
+	std::size_t nVisited = 0;
+	myWorld.ForeachEntity([&](flf::EntityId, flf::Res<Time> time, const Position &pos, RedTag, flf::Res<const Time> constTime)
+	                      {
+		                      CHECK_EQ(&*time, &*constTime);
+		                      CHECK_EQ(pos.x, float(nVisited) + 1);
+		                      time->deltaTime += 1;
+		                      ++nVisited;
+	                      });
+	CHECK_EQ(nVisited, 8);
+	CHECK_EQ(myWorld.Resource<Time>().deltaTime, 8.5f);
+	
+	const auto aliveBefore = LifetimeCounter::nAlive;
+	myWorld.SetResource<LifetimeCounter>(3);
+	myWorld.SetResource<LifetimeCounter>(4);
+	CHECK_EQ(LifetimeCounter::nAlive, aliveBefore + 1);
+	CHECK_EQ(myWorld.Resource<LifetimeCounter>().value, 4);
+	myWorld.RemoveResource<LifetimeCounter>();
+	CHECK_FALSE(myWorld.HasResource<LifetimeCounter>());
+	CHECK_EQ(LifetimeCounter::nAlive, aliveBefore);
+}
+
+TEST_CASE("World Hierarchy")
+{
+	flf::World myWorld{};
+	
+	// root -> a -> b -> c, root -> d, e has no relationships
+	flf::Entity root = myWorld.CreateEntity(Position{1, 0, 0});
+	flf::Entity a = myWorld.CreateEntity(Position{2, 0, 0});
+	flf::Entity b = myWorld.CreateEntity(Position{3, 0, 0}, RedTag{});
+	flf::Entity c = myWorld.CreateEntity(Position{4, 0, 0});
+	flf::Entity d = myWorld.CreateEntity(Position{5, 0, 0}, BlueTag{});
+	flf::Entity e = myWorld.CreateEntity(Position{6, 0, 0});
+	
+	// attach deepest first, so that the depth order differs from the creation order
+	myWorld.SetParent(c, b);
+	myWorld.SetParent(b, a);
+	myWorld.SetParent(d, root);
+	myWorld.SetParent(a, root);
+	
+	CHECK_EQ(myWorld.ParentOf(c).second.Id(), b.Id());
+	CHECK_FALSE(myWorld.ParentOf(root).first);
+	CHECK_FALSE(myWorld.ParentOf(e).first);
+	
+	std::vector<flf::EntityId> children{};
+	myWorld.ForeachChild(root, [&](flf::EntityId child) { children.push_back(child); });
+	std::sort(children.begin(), children.end());
+	CHECK_EQ(children, std::vector<flf::EntityId>{a.Id(), d.Id()});
+	
+	std::vector<flf::EntityId> visited{};
+	myWorld.ForeachInHierarchy([&](flf::EntityId child, flf::EntityId parent)
+	                           {
+		                           // parents are always visited before their children
+		                           CHECK(std::find(visited.cbegin(), visited.cend(), child) == visited.cend());
+		                           if (parent != root.Id())
+		                           {
+			                           CHECK(std::find(visited.cbegin(), visited.cend(), parent) != visited.cend());
+		                           }
+		                           visited.push_back(child);
+	                           });
+	CHECK_EQ(visited.size(), 4);
+	
+	// accumulate the positions from the root to the leaves
+	myWorld.Propagate<Position>([](const Position &parent, Position &child) { child.x += parent.x; });
+	CHECK_EQ(c.Get<Position>()->x, 10.f);
+	CHECK_EQ(d.Get<Position>()->x, 6.f);
+	CHECK_EQ(e.Get<Position>()->x, 6.f);
+	
+	// reparenting updates the depth of the whole subtree
+	myWorld.SetParent(b, d);
+	myWorld.RemoveParent(d);
+	CHECK_FALSE(myWorld.ParentOf(d).first);
+	visited.clear();
+	myWorld.ForeachInHierarchy([&](flf::EntityId child, flf::EntityId) { visited.push_back(child); });
+	CHECK_EQ(visited, std::vector<flf::EntityId>{a.Id(), b.Id(), c.Id()});
+	
+	// propagation follows the new parents
+	const float bx = b.Get<Position>()->x;
+	const float cx = c.Get<Position>()->x;
+	const float dx = d.Get<Position>()->x;
+	myWorld.Propagate<Position>([](const Position &parent, Position &child) { child.x += parent.x; });
+	CHECK_EQ(b.Get<Position>()->x, bx + dx);
+	CHECK_EQ(c.Get<Position>()->x, cx + bx + dx);
+	CHECK_EQ(d.Get<Position>()->x, dx);
+	
+	// destroying a parent destroys its children
+	d.Destroy();
+	CHECK(b.IsDead());
+	CHECK(c.IsDead());
+	CHECK_FALSE(a.IsDead());
+	
+	myWorld.SetParent(e, a);
+	myWorld.DestroyAll<Position>();
+	CHECK(root.IsDead());
+	CHECK(e.IsDead());
+	
+	std::size_t nVisited = 0;
+	myWorld.ForeachInHierarchy([&](flf::EntityId, flf::EntityId) { ++nVisited; });
+	CHECK_EQ(nVisited, 0);
+}
+
+TEST_CASE("World Propagate with missing components")
+{
+	flf::World myWorld{};
+	myWorld.DeclareSparse<Selected>();
+	
+	// a -> b -> c, a -> d, where b has neither Position nor Selected
+	flf::Entity a = myWorld.CreateEntity(Position{1, 0, 0}, Selected{1});
+	flf::Entity b = myWorld.CreateEntity(Velocity{2, 0, 0});
+	flf::Entity c = myWorld.CreateEntity(Position{3, 0, 0}, Selected{3});
+	flf::Entity d = myWorld.CreateEntity(Position{4, 0, 0});
+	myWorld.SetParent(b, a);
+	myWorld.SetParent(c, b);
+	myWorld.SetParent(d, a);
+	
+	myWorld.Propagate<Position>([](const Position &parent, Position &child) { child.x += parent.x; });
+	CHECK_EQ(c.Get<Position>()->x, 3.f);
+	CHECK_EQ(d.Get<Position>()->x, 5.f);
+	CHECK_EQ(b.Get<Velocity>()->dx, 2.f);
+	
+	std::size_t nPairs = 0;
+	myWorld.Propagate<Selected>([&](const Selected &, Selected &) { ++nPairs; });
+	CHECK_EQ(nPairs, 0);
+	myWorld.SetParent(c, a);
+	myWorld.Propagate<Selected>([&](const Selected &parent, Selected &child) { child.frame += parent.frame; ++nPairs; });
+	CHECK_EQ(nPairs, 1);
+	CHECK_EQ(c.Get<Selected>()->frame, 4);
+	
+	a.Destroy();
+	CHECK(b.IsDead());
+	CHECK(c.IsDead());
+	CHECK(d.IsDead());
+}
+
+TEST_CASE("World deep Hierarchy")
+{
+	flf::World myWorld{};
+	
+	// a long chain, as every level would add a stack frame to a recursive implementation
+	constexpr int DEPTH = 10000;
+	std::vector<flf::Entity> chain{};
+	chain.push_back(myWorld.CreateEntity(Position{1, 0, 0}));
+	for (int i = 1; i < DEPTH; ++i)
+	{
+		chain.push_back(myWorld.CreateEntity(Position{1, 0, 0}));
+		myWorld.SetParent(chain[i], chain[i - 1]);
+	}
+	
+	// detaching near the root updates the depths of the whole chain
+	myWorld.RemoveParent(chain[1]);
+	myWorld.SetParent(chain[1], chain[0]);
+	myWorld.Propagate<Position>([](const Position &parent, Position &child) { child.x = parent.x + 1; });
+	CHECK_EQ(chain.back().Get<Position>()->x, float(DEPTH));
+	
+	chain[1].Destroy();
+	CHECK(chain.back().IsDead());
+	CHECK_FALSE(chain[0].IsDead());
+	
+	std::size_t nVisited = 0;
+	myWorld.ForeachInHierarchy([&](flf::EntityId, flf::EntityId) { ++nVisited; });
+	CHECK_EQ(nVisited, 0);
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World Prefab")
+{
+	const int nAliveBefore = LifetimeCounter::nAlive;
+	{
+		flf::World myWorld{};
+		const flf::Prefab prefab = myWorld.CreatePrefab(Position{1, 2, 3}, LifetimeCounter{7}, RedTag{});
+		
+		flf::Entity single = myWorld.Instantiate(prefab);
+		CHECK_EQ(single.Get<Position>()->y, 2.f);
+		CHECK(single.Has<RedTag>());
+		
+		myWorld.PrefabValue<Position>(prefab).y = 5;
+		myWorld.Instantiate(prefab, 100);
+		CHECK_EQ(single.Get<Position>()->y, 2.f);
+		
+		std::size_t nInstances = 0;
+		float ySum = 0;
+		myWorld.Foreach([&](const Position &position, const LifetimeCounter &counter, RedTag)
+		                {
+			                ++nInstances;
+			                ySum += position.y;
+			                CHECK_EQ(counter.value, 7);
+		                });
+		CHECK_EQ(nInstances, 101);
+		CHECK_EQ(ySum, 2.f + 100 * 5.f);
+		// one value is saved in the prefab
+		CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 102);
+		
+		// copy an existing entity, sparse components are not copied
+		myWorld.DeclareSparse<Selected>();
+		flf::Entity prototype = myWorld.CreateEntity(Velocity{4, 5, 6}, Position{});
+		myWorld.AddComponent(prototype, Selected{1});
+		const flf::Prefab copied = myWorld.CreatePrefabFrom(prototype);
+		myWorld.Instantiate(copied, 10);
+		nInstances = 0;
+		myWorld.Foreach([&](const Velocity &velocity, const Position &)
+		                {
+			                ++nInstances;
+			                CHECK_EQ(velocity.dz, 6.f);
+		                });
+		CHECK_EQ(nInstances, 11);
+		std::size_t nSelected = 0;
+		myWorld.Foreach([&](const Selected &) { ++nSelected; });
+		CHECK_EQ(nSelected, 1);
+		
+		myWorld.DestroyAll<LifetimeCounter>();
+		CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 1);
+	}
+	CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore);
+}
+
+TEST_CASE("World runtime components")
+{
+	flf::World myWorld{};
+	
+	// a component only known at runtime, made of two floats initialized to 100
+	flf::internal::ConstructorVTable healthConstructors{
+			[](void *at) { new(at) float[2]{100.f, 100.f}; },
+			[](void *at, void *from) { std::memcpy(at, from, 2 * sizeof(float)); },
+			[](void *at, void *from) { std::memcpy(at, from, 2 * sizeof(float)); },
+			[](void *) {},
+			true, true, false};
+	const flf::IdType health = myWorld.RegisterComponent("Health", 2 * sizeof(float), alignof(float), healthConstructors);
+	const flf::IdType poisoned = myWorld.RegisterComponent("Poisoned", 0, 1, {});
+	const flf::IdType position = myWorld.RegisterComponent<Position>();
+	CHECK(myWorld.IsRegistered(health));
+	CHECK_FALSE(myWorld.IsRegistered(flf::TypeId<Velocity>()));
+	
+	const flf::IdType types[] = {position, health};
+	myWorld.CreateMultipleOf(10, types, 2);
+	flf::Entity entity = myWorld.CreateEntityOf(types, 2);
+	static_cast<float *>(myWorld.GetRaw(entity, health))[0] = 50.f;
+	
+	// runtime and C++ types share their Archetypes
+	CHECK(entity.Has<Position>());
+	myWorld.AddComponent(entity, Velocity{1, 2, 3});
+	CHECK_EQ(static_cast<float *>(myWorld.GetRaw(entity, health))[0], 50.f);
+	CHECK_EQ(myWorld.AddComponentOf(entity, poisoned), nullptr);
+	CHECK_EQ(myWorld.GetRaw(entity, flf::TypeId<Velocity>()), entity.Get<Velocity>());
+	
+	std::size_t nEntities = 0;
+	float healthSum = 0;
+	const flf::IdType query[] = {health, position};
+	myWorld.ForeachColumns(query, 2, [&](std::size_t count, const flf::EntityId *, void *const *columns)
+	{
+		const auto *healthColumn = static_cast<const float *>(columns[0]);
+		CHECK_NE(columns[1], nullptr);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			healthSum += healthColumn[2 * i];
+		}
+		nEntities += count;
+	});
+	CHECK_EQ(nEntities, 11);
+	CHECK_EQ(healthSum, 10 * 100.f + 50.f);
+	
+	myWorld.RemoveComponentOf(entity, health);
+	CHECK_EQ(myWorld.GetRaw(entity, health), nullptr);
+	CHECK_EQ(entity.Get<Velocity>()->dz, 3.f);
+	
+	// grouped types are passed one entity at a time when the query also needs other types
+	myWorld.DeclareGroup<Position, Velocity>();
+	flf::Entity grouped = myWorld.CreateEntity(Position{}, Velocity{});
+	myWorld.AddComponentOf(grouped, health);
+	const flf::IdType mixedQuery[] = {health, flf::TypeId<Velocity>()};
+	nEntities = 0;
+	myWorld.ForeachColumns(mixedQuery, 2, [&](std::size_t count, const flf::EntityId *ids, void *const *columns)
+	{
+		CHECK_EQ(count, 1);
+		CHECK_EQ(ids[0], grouped.Id());
+		CHECK_EQ(columns[1], grouped.Get<Velocity>());
+		nEntities += count;
+	});
+	CHECK_EQ(nEntities, 1);
+}
+
+TEST_CASE("World DynamicQuery")
+{
+	flf::World myWorld{};
+	myWorld.CreateMultiple(4, Position{1, 0, 0});
+	myWorld.CreateMultiple(3, Position{2, 0, 0}, Velocity{1, 1, 1});
+	myWorld.CreateMultiple(2, Position{4, 0, 0}, Velocity{2, 2, 2}, RedTag{});
+	myWorld.CreateMultiple(5, Velocity{});
+	
+	// C++ types can be named by their type name
+	CHECK_EQ(flf::DynamicQuery().With("Position").GetRequired()[0], flf::TypeId<Position>());
+	
+	flf::DynamicQuery query{};
+	query.With("Position").Optional(flf::TypeId<Velocity>()).Without(flf::TypeId<RedTag>());
+	std::size_t nRanges = 0;
+	std::size_t nEntities = 0;
+	float positionSum = 0;
+	float velocitySum = 0;
+	myWorld.ForeachColumns(query, [&](std::size_t count, const flf::EntityId *, void *const *columns)
+	{
+		++nRanges;
+		nEntities += count;
+		const auto *positions = static_cast<const Position *>(columns[0]);
+		const auto *velocities = static_cast<const Velocity *>(columns[1]);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			positionSum += positions[i].x;
+			velocitySum += velocities ? velocities[i].dx : 0;
+		}
+	});
+	CHECK_EQ(nRanges, 2);
+	CHECK_EQ(nEntities, 7);
+	CHECK_EQ(positionSum, 4 * 1.f + 3 * 2.f);
+	CHECK_EQ(velocitySum, 3 * 1.f);
+	
+	// with filters the entities of a group are visited through their containers
+	myWorld.DeclareGroup<Position, Velocity>();
+	nEntities = 0;
+	velocitySum = 0;
+	myWorld.ForeachColumns(query, [&](std::size_t count, const flf::EntityId *, void *const *columns)
+	{
+		nEntities += count;
+		const auto *velocities = static_cast<const Velocity *>(columns[1]);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			velocitySum += velocities ? velocities[i].dx : 0;
+		}
+	});
+	CHECK_EQ(nEntities, 7);
+	CHECK_EQ(velocitySum, 3 * 1.f);
+}
+
+TEST_CASE("World ForeachColumns with holes")
+{
+	flf::World myWorld{};
+	myWorld.SetRemovalPolicy(flf::RemovalPolicy::KeepOrder);
+	std::vector<flf::Entity> entities{};
+	for (int i = 0; i < 8; ++i)
+	{
+		entities.push_back(myWorld.CreateEntity(Position{float(i), 0, 0}));
+	}
+	entities[1].Destroy();
+	
+	// the rows around the hole are passed as separate ranges and the container is not compacted, so the outer
+	// iteration still visits every entity exactly once
+	const flf::IdType query[] = {flf::TypeId<Position>()};
+	std::vector<float> visited{};
+	std::size_t nRanges = 0;
+	std::size_t nEntities = 0;
+	myWorld.Foreach([&](const Position &position)
+	{
+		visited.push_back(position.x);
+		nRanges = 0;
+		nEntities = 0;
+		myWorld.ForeachColumns(query, 1, [&](std::size_t count, const flf::EntityId *rangeIds, void *const *columns)
+		{
+			++nRanges;
+			nEntities += count;
+			const auto *positions = static_cast<const Position *>(columns[0]);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				CHECK_EQ(entities[std::size_t(positions[i].x)].Id(), rangeIds[i]);
+			}
+		});
+	});
+	CHECK_EQ(visited, std::vector<float>{0, 2, 3, 4, 5, 6, 7});
+	CHECK_EQ(nRanges, 2);
+	CHECK_EQ(nEntities, 7);
+}
+
+/// Counts the allocations of all memory resources of worlds created while it is alive. Every resource of a world draws
+/// its memory from the default resource, which this replaces until it is destroyed, so it has to outlive the worlds
+class CountingResource final :
+		public std::pmr::memory_resource
+{
+public:
+	CountingResource() : _upstream(std::pmr::set_default_resource(this))
+	{
+	}
+	
+	CountingResource(const CountingResource &) = delete;
+	
+	CountingResource &operator=(const CountingResource &) = delete;
+	
+	~CountingResource() override
+	{
+		std::pmr::set_default_resource(_upstream);
+	}
+	
+	[[nodiscard]] std::size_t AllocationCount() const
+	{
+		return _nAllocations.load();
+	}
+
+private:
+	void *do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		++_nAllocations;
+		return _upstream->allocate(bytes, alignment);
+	}
+	
+	void do_deallocate(void *memory, std::size_t bytes, std::size_t alignment) override
+	{
+		_upstream->deallocate(memory, bytes, alignment);
+	}
+	
+	[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+	{
+		return this == &other;
+	}
+
+private:
+	std::pmr::memory_resource *_upstream;
+	std::atomic<std::size_t> _nAllocations{0};
+};
+
+TEST_CASE("World steady state does not allocate")
+{
+	const CountingResource allocations{};
+	flf::World myWorld{};
+	myWorld.CreateMultiple<Position, Velocity>(64);
+	myWorld.CreateMultiple<Position>(64);
+	myWorld.SetResource<Time>(Time{0.5f});
+	flf::Entity entity = myWorld.CreateEntity(Position{});
+	
+	float sum = 0;
+	const auto frame = [&]()
+	{
+#ifdef FLUFF_PROFILE
+		myWorld.GetProfiler().Clear();
+#endif
+		myWorld.Foreach([&](Position &position, const Velocity &velocity) { position.x += velocity.dx; });
+		myWorld.Foreach([&](const Position &position, flf::Res<const Time> time) { sum += position.x * time->deltaTime; });
+		myWorld.ForeachEntity([&](flf::EntityId, const Position &position) { sum += position.y; });
+		sum += myWorld.Get<Position>(entity).x;
+		myWorld.AddComponent(entity, Velocity{1, 2, 3});
+		sum += entity.Get<Velocity>()->dx;
+		myWorld.RemoveComponent<Velocity>(entity);
+	};
+	
+	// the first frame creates the Archetypes and query caches
+	frame();
+	const std::size_t nAllocationsBefore = allocations.AllocationCount();
+	for (int i = 0; i < 100; ++i)
+	{
+		frame();
+	}
+	CHECK_EQ(allocations.AllocationCount(), nAllocationsBefore);
+}
+
+TEST_CASE("World growth policy and ShrinkToFit")
+{
+	constexpr std::size_t N_ENTITIES = 10000;
+	
+	SUBCASE("ShrinkToFit after a mass despawn")
+	{
+		flf::World myWorld{};
+		myWorld.CreateMultiple<Position>(N_ENTITIES);
+		myWorld.CreateMultiple<Position, Velocity>(10);
+		const std::size_t fullCapacity = myWorld.GetComponentByteCapacity();
+		CHECK_GE(fullCapacity, N_ENTITIES * sizeof(Position));
+		
+		myWorld.DestroyAll<Position>();
+		CHECK_EQ(myWorld.GetComponentByteCapacity(), fullCapacity);
+		myWorld.CreateMultiple<Position, Velocity>(10);
+		
+		myWorld.ShrinkToFit();
+		CHECK_EQ(myWorld.GetComponentByteCapacity(), 10 * (sizeof(Position) + sizeof(Velocity)));
+		CHECK_EQ(myWorld.GetPeakComponentByteCapacity(), fullCapacity);
+		
+		std::size_t count = 0;
+		myWorld.Foreach([&](const Position &, const Velocity &) { ++count; });
+		CHECK_EQ(count, 10);
+		myWorld.DestroyAll<Position>();
+	}
+	
+	SUBCASE("Automatic trimming")
+	{
+		flf::World myWorld{};
+		myWorld.SetGrowthPolicy({2.0, 0, 0, 0.25});
+		myWorld.CreateMultiple<Position>(N_ENTITIES);
+		const std::size_t fullCapacity = myWorld.GetComponentByteCapacity();
+		
+		myWorld.DestroyAll<Position>();
+		CHECK_LT(myWorld.GetComponentByteCapacity(), fullCapacity / 100);
+		CHECK_EQ(myWorld.GetPeakComponentByteCapacity(), fullCapacity);
+	}
+	
+	SUBCASE("Linear growth")
+	{
+		flf::World myWorld{};
+		myWorld.SetGrowthPolicy({1.0, 100});
+		for (std::size_t i = 0; i < 1000; ++i)
+		{
+			myWorld.CreateEntity(Position{});
+		}
+		CHECK_LE(myWorld.GetComponentByteCapacity(), 1100 * sizeof(Position));
+		myWorld.DestroyAll<Position>();
+	}
+}
+
+TEST_CASE("World shared column allocation")
+{
+	const int nAliveBefore = LifetimeCounter::nAlive;
+	flf::World myWorld{};
+	myWorld.SetSharedColumnAllocation(true);
+	std::vector<flf::Entity> entities{};
+	for (int i = 0; i < 1000; ++i)
+	{
+		entities.push_back(myWorld.CreateEntity(Position{static_cast<float>(i), 0, 0}, Velocity{1, 0, 0}, LifetimeCounter{i}));
+	}
+	
+	// all columns are parts of one allocation with the same capacity
+	const flf::IdType query[] = {flf::TypeId<Position>(), flf::TypeId<Velocity>(), flf::TypeId<LifetimeCounter>()};
+	std::array<std::uintptr_t, 3> columnAddresses{};
+	myWorld.ForeachColumns(query, 3, [&](std::size_t count, const flf::EntityId *, void *const *columns)
+	{
+		CHECK_EQ(count, 1000);
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			columnAddresses[i] = reinterpret_cast<std::uintptr_t>(columns[i]);
+		}
+	});
+	const auto [first, last] = std::minmax_element(columnAddresses.cbegin(), columnAddresses.cend());
+	CHECK_LE(*last - *first, 1024 * (sizeof(Position) + sizeof(Velocity)) + 2 * flf::internal::ColumnArena::COLUMN_ALIGNMENT);
+	
+	myWorld.Sort<LifetimeCounter>([](const LifetimeCounter &lhs, const LifetimeCounter &rhs) { return lhs.value > rhs.value; });
+	std::vector<flf::Entity> evenEntities{};
+	for (std::size_t i = 0; i < entities.size(); ++i)
+	{
+		if (i % 2 == 0)
+		{
+			evenEntities.push_back(entities[i]);
+		} else if (i % 3 == 0)
+		{
+			myWorld.RemoveComponent<Velocity>(entities[i]);
+		}
+	}
+	myWorld.Destroy(evenEntities);
+	myWorld.ShrinkToFit();
+	myWorld.SetSharedColumnAllocation(false);
+	
+	std::size_t nEntities = 0;
+	myWorld.Foreach([&](const Position &position, const LifetimeCounter &counter)
+	{
+		CHECK_EQ(static_cast<int>(position.x), counter.value);
+		CHECK_EQ(counter.value % 2, 1);
+		++nEntities;
+	});
+	CHECK_EQ(nEntities, 500);
+	CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 500);
+	myWorld.DestroyAll<LifetimeCounter>();
+}
+
+TEST_CASE("HugePageResource")
+{
+	flf::HugePageResource resource{flf::HugePageOptions{1024 * 1024, true, flf::NumaPlacement::CallerNode}};
+	
+	void *small = resource.allocate(64, 8);
+	CHECK_EQ(resource.GetMappedBytes(), 0);
+	void *large = resource.allocate(3 * 1024 * 1024, 64);
+	CHECK_EQ(reinterpret_cast<std::uintptr_t>(large) % flf::HugePageResource::HUGE_PAGE_SIZE, 0);
+	CHECK_EQ(resource.GetMappedBytes(), 2 * flf::HugePageResource::HUGE_PAGE_SIZE);
+	std::memset(large, 1, 3 * 1024 * 1024);
+	resource.deallocate(large, 3 * 1024 * 1024, 64);
+	resource.deallocate(small, 64, 8);
+	CHECK_EQ(resource.GetMappedBytes(), 0);
+	
+	flf::BasicWorld<flf::HugePageResource> myWorld{};
+	myWorld.CreateMultiple<Position>(300000);
+	myWorld.CreateEntity(Position{1, 2, 3}, Velocity{1, 0, 0});
+	float sum = 0;
+	myWorld.Foreach([&](const Position &position) { sum += position.y; });
+	CHECK_EQ(sum, 2.f);
+}
+
+TEST_CASE("World memory stats")
+{
+	flf::World myWorld{};
+	myWorld.DeclareSparse<Selected>();
+	myWorld.CreateMultiple<Position>(100);
+	myWorld.CreateMultiple<Position, Velocity>(50);
+	flf::Entity entity = myWorld.CreateEntity(Position{});
+	myWorld.AddComponent(entity, Selected{});
+	
+	const flf::WorldMemoryStats stats = myWorld.GetMemoryStats();
+	CHECK_EQ(stats.entityCount, 151);
+	CHECK_EQ(stats.archetypeCount, 2);
+	CHECK_EQ(stats.usedBytes, 151 * sizeof(Position) + 50 * sizeof(Velocity) + sizeof(Selected));
+	CHECK_EQ(stats.reservedBytes, myWorld.GetComponentByteCapacity());
+	CHECK_GE(stats.reservedBytes, stats.usedBytes);
+	CHECK_GT(stats.idBytes, 0);
+	CHECK_GT(stats.entityLookupBytes, 0);
+	CHECK(stats.Fragmentation() >= 0.0);
+	CHECK(stats.Fragmentation() < 1.0);
+	
+	const flf::ColumnMemoryStats positions = myWorld.GetComponentMemory<Position>();
+	CHECK_EQ(positions.usedBytes, 151 * sizeof(Position));
+	CHECK_GE(positions.reservedBytes, positions.usedBytes);
+	
+	std::size_t nArchetypes = 0;
+	std::size_t reservedBytes = 0;
+	myWorld.ForeachArchetypeMemory([&](const flf::ArchetypeMemoryStats &archetypeStats, const flf::Archetype &archetype)
+	{
+		CHECK_EQ(archetypeStats.columnCount, archetype.ColumnCount());
+		CHECK_GE(archetypeStats.capacity, archetypeStats.entityCount);
+		reservedBytes += archetypeStats.reservedBytes;
+		++nArchetypes;
+	});
+	CHECK_EQ(nArchetypes, 2);
+	CHECK_EQ(reservedBytes + myWorld.GetComponentMemory<Selected>().reservedBytes, stats.reservedBytes);
+}
+
+TEST_CASE("Profiler")
+{
+	flf::Profiler profiler{};
+	{
+		flf::ProfileScope system{profiler, "System \"A\""};
+		profiler.Begin("Query");
+		profiler.Visit(10);
+		profiler.Visit(0);
+		profiler.Visit(5);
+		profiler.End();
+	}
+	
+	const std::vector<flf::ProfileEvent> &events = profiler.GetEvents();
+	REQUIRE_EQ(events.size(), 2);
+	CHECK_EQ(events[0].name, "System \"A\"");
+	CHECK_EQ(events[0].depth, 0);
+	CHECK_EQ(events[0].archetypesVisited, 0);
+	CHECK_EQ(events[1].name, "Query");
+	CHECK_EQ(events[1].depth, 1);
+	CHECK_EQ(events[1].entitiesVisited, 15);
+	CHECK_EQ(events[1].archetypesVisited, 2);
+	CHECK_EQ(events[1].archetypesSkipped, 1);
+	CHECK_GE(events[1].beginNs, events[0].beginNs);
+	CHECK_LE(events[1].durationNs, events[0].durationNs);
+	
+	std::ostringstream trace{};
+	profiler.WriteChromeTrace(trace, 3);
+	const std::string json = trace.str();
+	CHECK_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+	CHECK_NE(json.find("\"name\":\"System \\\"A\\\"\""), std::string::npos);
+	CHECK_NE(json.find("\"tid\":3"), std::string::npos);
+	CHECK_NE(json.find("\"args\":{\"entities\":15,\"archetypes\":2,\"skipped\":1}"), std::string::npos);
+	
+	profiler.Clear();
+	CHECK(profiler.GetEvents().empty());
+
+#ifdef FLUFF_PROFILE
+	flf::World myWorld{};
+	for (int i = 0; i < 20; ++i)
+	{
+		myWorld.CreateEntity(Position{}, Velocity{});
+	}
+	myWorld.CreateEntity(Position{});
+	{
+		FLUFF_PROFILE_SCOPE(myWorld.GetProfiler(), "Movement");
+		myWorld.Foreach([](Position &, const Velocity &) {});
+	}
+	
+	const std::vector<flf::ProfileEvent> &worldEvents = myWorld.GetProfiler().GetEvents();
+	REQUIRE_EQ(worldEvents.size(), 2);
+	CHECK_EQ(worldEvents[0].name, "Movement");
+	CHECK_EQ(worldEvents[1].depth, 1);
+	CHECK_EQ(worldEvents[1].entitiesVisited, 20);
+	CHECK_EQ(worldEvents[1].archetypesVisited, 1);
+	
+	// reader threads do not write to the profiler, not even on the sparse path
+	myWorld.DeclareSparse<Selected>();
+	myWorld.AddComponent(myWorld.CreateEntity(Position{}), Selected{});
+	myWorld.GetProfiler().Clear();
+	{
+		FLUFF_PROFILE_SCOPE(myWorld.GetProfiler(), "Readers");
+		const flf::WorldView view(myWorld);
+		int nSelected = 0;
+		view.Foreach([&](const Position &, const Selected &) { ++nSelected; });
+		CHECK_EQ(nSelected, 1);
+	}
+	REQUIRE_EQ(worldEvents.size(), 1);
+	CHECK_EQ(worldEvents[0].entitiesVisited, 0);
+	CHECK_EQ(worldEvents[0].archetypesVisited, 0);
+	myWorld.DestroyAll<Position>();
+#endif
+}
+
+TEST_CASE("World structural change stats")
+{
+	flf::World myWorld{};
+	std::vector<flf::Entity> entities{};
+	for (int i = 0; i < 100; ++i)
+	{
+		entities.push_back(myWorld.CreateEntity(Position{}));
+	}
+	
+	const flf::StructuralChangeStats &created = myWorld.GetStructuralChangeStats();
+	CHECK_EQ(created.archetypesCreated, 1);
+	CHECK_GT(created.vectorReallocations, 0);
+	CHECK_GT(created.sparseResizes, 0);
+	
+	myWorld.ResetStructuralChangeStats();
+	// later entities are moved first, so the sparse set of the destination has to keep their entries
+	for (auto entity = entities.rbegin(); entity != entities.rend(); ++entity)
+	{
+		myWorld.AddComponent(*entity, Velocity{});
+	}
+	myWorld.RemoveComponent<Velocity>(entities[0]);
+	
+	const flf::StructuralChangeStats &stats = myWorld.GetStructuralChangeStats();
+	CHECK_EQ(stats.archetypesCreated, 1);
+	CHECK_EQ(stats.entitiesMoved, 101);
+	CHECK_EQ(stats.bytesMoved, 101 * sizeof(Position));
+	for (const flf::Entity entity : entities)
+	{
+		CHECK_EQ(entity.Has<Velocity>(), entity.Id() != entities[0].Id());
+	}
+	
+	const flf::MultiIdType positionOnly = flf::TypeId<Position>();
+	std::size_t nTransitions = 0;
+	myWorld.ForeachTransition([&](const flf::TransitionStats &transition)
+	{
+		++nTransitions;
+		if (transition.source == positionOnly)
+		{
+			CHECK_EQ(transition.entitiesMoved, 100);
+			CHECK_EQ(transition.bytesMoved, 100 * sizeof(Position));
+		} else
+		{
+			CHECK_EQ(transition.destination, positionOnly);
+			CHECK_EQ(transition.entitiesMoved, 1);
+		}
+	});
+	CHECK_EQ(nTransitions, 2);
+	
+	myWorld.ResetStructuralChangeStats();
+	CHECK_EQ(myWorld.GetStructuralChangeStats().entitiesMoved, 0);
+	nTransitions = 0;
+	myWorld.ForeachTransition([&](const flf::TransitionStats &) { ++nTransitions; });
+	CHECK_EQ(nTransitions, 0);
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World EntityStage")
+{
+	flf::World myWorld{};
+	myWorld.CreateEntity(Position{}, Velocity{});
+	
+	constexpr int N_THREADS = 4;
+	constexpr int N_PER_THREAD = 500;
+	std::vector<flf::EntityStage> stages{};
+	for (int i = 0; i < N_THREADS; ++i)
+	{
+		stages.push_back(myWorld.CreateStage(*std::pmr::new_delete_resource(), 64));
+	}
+	
+	std::vector<std::vector<flf::EntityId>> ids(N_THREADS);
+	std::vector<std::thread> threads{};
+	for (int t = 0; t < N_THREADS; ++t)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (int i = 0; i < N_PER_THREAD; ++i)
+			{
+				const float x = static_cast<float>(t * N_PER_THREAD + i);
+				if (i % 2 == 0)
+				{
+					ids[t].push_back(stages[t].CreateEntity(Position{x, 0, 0}, Velocity{1, 2, 3}));
+				} else
+				{
+					ids[t].push_back(stages[t].CreateEntity(RedTag{}, Position{x, 0, 0}));
+				}
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	
+	for (flf::EntityStage &stage : stages)
+	{
+		CHECK_EQ(stage.Size(), N_PER_THREAD);
+		myWorld.Merge(stage);
+		CHECK_EQ(stage.Size(), 0);
+	}
+	
+	std::vector<flf::EntityId> allIds{};
+	for (int t = 0; t < N_THREADS; ++t)
+	{
+		for (int i = 0; i < N_PER_THREAD; ++i)
+		{
+			flf::Entity entity = myWorld.GetEntity(ids[t][i]);
+			CHECK_EQ(entity.Get<Position>()->x, static_cast<float>(t * N_PER_THREAD + i));
+			CHECK_EQ(entity.Has<RedTag>(), i % 2 != 0);
+			allIds.push_back(ids[t][i]);
+		}
+	}
+	std::sort(allIds.begin(), allIds.end());
+	CHECK(std::adjacent_find(allIds.cbegin(), allIds.cend()) == allIds.cend());
+	
+	std::size_t nMoving = 0;
+	myWorld.Foreach([&](const Position &, const Velocity &velocity) { nMoving += velocity.dy == 2 ? 1 : 0; });
+	CHECK_EQ(nMoving, N_THREADS * N_PER_THREAD / 2);
+	
+	// entities created directly get ids that were not reserved by any stage
+	const flf::Entity created = myWorld.CreateEntity(Position{-1, 0, 0});
+	CHECK_GT(created.Id(), allIds.back());
+	
+	SUBCASE("Clear destructs staged components")
+	{
+		flf::EntityStage stage = myWorld.CreateStage();
+		const int nAliveBefore = LifetimeCounter::nAlive;
+		stage.CreateEntity(LifetimeCounter{1});
+		stage.CreateEntity(LifetimeCounter{2});
+		CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 2);
+		stage.Clear();
+		CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore);
+		
+		const flf::EntityId id = stage.CreateEntity(LifetimeCounter{3});
+		myWorld.Merge(stage);
+		CHECK_EQ(myWorld.GetEntity(id).Get<LifetimeCounter>()->value, 3);
+		CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 1);
+		myWorld.DestroyAll<LifetimeCounter>();
+	}
+	
+	SUBCASE("Merge creates Archetypes from components in any order")
+	{
+		flf::World world{};
+		flf::EntityStage stage = world.CreateStage();
+		// one of both orders is not sorted by type id
+		stage.CreateEntity(Velocity{1, 0, 0}, Position{});
+		stage.CreateEntity(RedTag{}, Position{}, Quaternion{});
+		stage.CreateEntity(Quaternion{}, RedTag{}, Position{});
+		world.Merge(stage);
+		world.CreateEntity(Position{}, Velocity{1, 0, 0});
+		world.CreateEntity(Position{}, RedTag{}, Quaternion{});
+		
+		int nVelocities = 0;
+		world.Foreach([&](const Velocity &) { ++nVelocities; });
+		CHECK_EQ(nVelocities, 2);
+		int nPositions = 0;
+		world.Foreach([&](const Position &) { ++nPositions; });
+		CHECK_EQ(nPositions, 5);
+		int nTagged = 0;
+		world.Foreach([&](RedTag, const Quaternion &) { ++nTagged; });
+		CHECK_EQ(nTagged, 3);
+	}
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World WorldView")
+{
+	flf::World myWorld{};
+	myWorld.DeclareSparse<Selected>();
+	std::vector<flf::Entity> entities{};
+	for (int i = 0; i < 300; ++i)
+	{
+		if (i % 3 == 0)
+		{
+			entities.push_back(myWorld.CreateEntity(Position{float(i), 0, 0}, Velocity{1, 0, 0}));
+		} else
+		{
+			entities.push_back(myWorld.CreateEntity(RedTag{}, Position{float(i), 0, 0}));
+		}
+	}
+	myWorld.AddComponent(entities[10], Selected{10});
+	myWorld.AddComponent(entities[20], Selected{20});
+	// iterating once caches the Archetypes, so the view does not need to search for them
+	myWorld.Foreach([](const Position &) {});
+	
+	const flf::WorldView view(myWorld);
+	CHECK(view.Contains(entities[5].Id()));
+	CHECK(view.Has<RedTag>(entities[5].Id()));
+	CHECK_FALSE(view.Has<Velocity>(entities[5].Id()));
+	CHECK_EQ(view.Get<Position>(entities[7].Id()).x, 7);
+	CHECK_EQ(view.TryGet<Velocity>(entities[7].Id()), nullptr);
+	CHECK_EQ(view.TryGet<Velocity>(entities[9].Id())->dx, 1);
+	CHECK_EQ(view.TryGet<Selected>(entities[20].Id())->frame, 20);
+	CHECK_EQ(view.TryGet<Selected>(entities[21].Id()), nullptr);
+	
+	constexpr int N_THREADS = 4;
+	std::vector<float> sums(N_THREADS);
+	std::vector<std::size_t> nMoving(N_THREADS);
+	std::vector<int> nSelected(N_THREADS);
+	const flf::StructuralChangeStats changesBefore = myWorld.GetStructuralChangeStats();
+	const flf::WorldMemoryStats memoryBefore = myWorld.GetMemoryStats();
+	std::vector<std::thread> threads{};
+	threads.reserve(N_THREADS);
+	for (int t = 0; t < N_THREADS; ++t)
+	{
+		threads.emplace_back([&, t]()
+		{
+			view.Foreach([&](const Position &position) { sums[t] += position.x; });
+			view.ForeachEntity([&](flf::EntityId id, const Position &, Velocity velocity)
+			                   {
+				                   nMoving[t] += view.Get<Velocity>(id).dx == velocity.dx ? 1 : 0;
+			                   });
+			view.Foreach([&](const Selected &selected, const Position &) { nSelected[t] += selected.frame; });
+		});
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	// the readers did not change the world
+	const flf::StructuralChangeStats changesAfter = myWorld.GetStructuralChangeStats();
+	CHECK_EQ(changesAfter.archetypesCreated, changesBefore.archetypesCreated);
+	CHECK_EQ(changesAfter.vectorReallocations, changesBefore.vectorReallocations);
+	CHECK_EQ(changesAfter.sparseResizes, changesBefore.sparseResizes);
+	CHECK_EQ(myWorld.GetMemoryStats().reservedBytes, memoryBefore.reservedBytes);
+	CHECK_EQ(myWorld.GetMemoryStats().idBytes, memoryBefore.idBytes);
+	
+	for (int t = 0; t < N_THREADS; ++t)
+	{
+		CHECK_EQ(sums[t], 299.0f * 300.0f / 2.0f);
+		CHECK_EQ(nMoving[t], 100);
+		CHECK_EQ(nSelected[t], 30);
+	}
+	
+	// types never iterated over by the world are searched for
+	std::size_t nRed = 0;
+	view.ForeachEntity([&](flf::EntityId, RedTag) { ++nRed; });
+	CHECK_EQ(nRed, 200);
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World MoveEntityTo another world")
+{
+	const int nAliveBefore = LifetimeCounter::nAlive;
+	flf::World source{};
+	flf::World destination{};
+	destination.CreateEntity(Position{-1, 0, 0});
+	
+	std::vector<flf::Entity> entities{};
+	for (int i = 0; i < 20; ++i)
+	{
+		if (i % 2 == 0)
+		{
+			entities.push_back(source.CreateEntity(Position{float(i), 0, 0}, LifetimeCounter{i}));
+		} else
+		{
+			entities.push_back(source.CreateEntity(RedTag{}, Position{float(i), 0, 0}, Velocity{float(i), 0, 0}));
+		}
+	}
+	
+	SUBCASE("Single entity")
+	{
+		const flf::Entity moved = source.MoveEntityTo(destination, entities[4]);
+		CHECK(entities[4].IsDead());
+		CHECK_FALSE(moved.IsDead());
+		CHECK_EQ(moved.Get<Position>()->x, 4);
+		CHECK_EQ(moved.Get<LifetimeCounter>()->value, 4);
+		CHECK_EQ(entities[6].Get<LifetimeCounter>()->value, 6);
+		CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 10);
+	}
+	
+	SUBCASE("Multiple entities")
+	{
+		const std::vector<flf::Entity> selected{entities[7], entities[2], entities[3], entities[10]};
+		const std::vector<flf::Entity> moved = source.MoveEntitiesTo(destination, selected);
+		REQUIRE_EQ(moved.size(), selected.size());
+		for (std::size_t i = 0; i < selected.size(); ++i)
+		{
+			CHECK(selected[i].IsDead());
+			CHECK_EQ(moved[i].Get<Position>()->x, float(selected[i].Id()));
+		}
+		CHECK(moved[0].Has<RedTag>());
+		CHECK_EQ(moved[0].Get<Velocity>()->dx, 7);
+		CHECK_EQ(moved[3].Get<LifetimeCounter>()->value, 10);
+		
+		std::size_t nSource = 0;
+		source.Foreach([&](const Position &) { ++nSource; });
+		CHECK_EQ(nSource, 16);
+		std::size_t nDestination = 0;
+		destination.Foreach([&](const Position &) { ++nDestination; });
+		CHECK_EQ(nDestination, 5);
+	}
+	
+	SUBCASE("Whole Archetypes")
+	{
+		destination.DeclareGroup<Position, Velocity>();
+		source.MoveAllTo<Position>(destination);
+		CHECK(entities[0].IsDead());
+		CHECK(entities[19].IsDead());
+		CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore + 10);
+		
+		float sum = 0;
+		destination.Foreach([&](const Position &position, const Velocity &velocity)
+		                    {
+			                    CHECK_EQ(position.x, velocity.dx);
+			                    sum += velocity.dx;
+		                    });
+		CHECK_EQ(sum, 1 + 3 + 5 + 7 + 9 + 11 + 13 + 15 + 17 + 19);
+		std::size_t nSource = 0;
+		source.Foreach([&](const Position &) { ++nSource; });
+		CHECK_EQ(nSource, 0);
+		CHECK_EQ(source.GetStructuralChangeStats().entitiesMoved, 20);
+	}
+	
+	SUBCASE("Sparse components and groups")
+	{
+		source.DeclareSparse<Selected>();
+		destination.DeclareSparse<Selected>();
+		source.DeclareGroup<Position, Velocity>();
+		const flf::Entity grouped = source.CreateEntity(Position{30, 0, 0}, Velocity{30, 0, 0});
+		source.AddComponent(grouped, Selected{30});
+		
+		const flf::Entity moved = source.MoveEntityTo(destination, grouped);
+		CHECK_EQ(moved.Get<Velocity>()->dx, 30);
+		CHECK_EQ(moved.Get<Selected>()->frame, 30);
+		CHECK(grouped.IsDead());
+		
+		std::size_t nSelected = 0;
+		source.Foreach([&](const Selected &) { ++nSelected; });
+		CHECK_EQ(nSelected, 0);
+	}
+	
+	SUBCASE("Transitions outlive the destination world")
+	{
+		auto other = std::make_unique<flf::World>();
+		source.MoveEntityTo(*other, entities[0]);
+		other->DestroyAll<Position>();
+		other.reset();
+		
+		std::size_t nTransitions = 0;
+		source.ForeachTransition([&](const flf::TransitionStats &transition)
+		                         {
+			                         CHECK_EQ(transition.destination, flf::MultiTypeId<Position, LifetimeCounter>());
+			                         CHECK_EQ(transition.entitiesMoved, 1);
+			                         ++nTransitions;
+		                         });
+		CHECK_EQ(nTransitions, 1);
+	}
+	source.DestroyAll<Position>();
+	destination.DestroyAll<Position>();
+	CHECK_EQ(LifetimeCounter::nAlive, nAliveBefore);
+}
+
+TEST_CASE("World Merge staging world")
+{
+	flf::World live{};
+	live.DeclareSparse<Selected>();
+	const flf::Entity existing = live.CreateEntity(Position{-1, 0, 0}, Velocity{-1, 0, 0});
+	
+	flf::World staging{};
+	staging.DeclareSparse<Selected>();
+	constexpr int N_ENTITIES = 5000;
+	std::thread loader([&staging]()
+	                   {
+		                   for (int i = 0; i < N_ENTITIES; ++i)
+		                   {
+			                   if (i % 5 == 0)
+			                   {
+				                   staging.CreateEntity(RedTag{}, Position{float(i), 0, 0});
+			                   } else
+			                   {
+				                   staging.CreateEntity(Position{float(i), 0, 0}, Velocity{float(i), 0, 0});
+			                   }
+		                   }
+		                   staging.SetParent(staging.GetEntity(1), staging.GetEntity(0));
+		                   staging.AddComponent(staging.GetEntity(2), Selected{2});
+	                   });
+	loader.join();
+	
+	const std::size_t reallocationsBefore = live.GetStructuralChangeStats().vectorReallocations;
+	std::vector<flf::EntityId> remap{};
+	live.Merge(staging, &remap);
+	// every vector of the live world grew at most once: two existing vectors, one new one and the sparse storage
+	CHECK_LE(live.GetStructuralChangeStats().vectorReallocations - reallocationsBefore, 4);
+	
+	REQUIRE_EQ(remap.size(), N_ENTITIES);
+	for (int i = 0; i < N_ENTITIES; ++i)
+	{
+		const flf::Entity merged = live.GetEntity(remap[i]);
+		CHECK_EQ(merged.Get<Position>()->x, float(i));
+		CHECK_EQ(merged.Has<RedTag>(), i % 5 == 0);
+	}
+	CHECK_EQ(live.ParentOf(live.GetEntity(remap[1])).second.Id(), remap[0]);
+	CHECK_EQ(live.GetEntity(remap[2]).Get<Selected>()->frame, 2);
+	CHECK_EQ(existing.Get<Velocity>()->dx, -1);
+	
+	std::size_t nStaged = 0;
+	staging.Foreach([&](const Position &) { ++nStaged; });
+	CHECK_EQ(nStaged, 0);
+	
+	// the staging world can be filled again
+	staging.CreateEntity(Position{7, 0, 0}, Velocity{7, 0, 0});
+	live.Merge(staging);
+	std::size_t nLive = 0;
+	live.Foreach([&](const Position &) { ++nLive; });
+	CHECK_EQ(nLive, N_ENTITIES + 2);
+	live.DestroyAll<Position>();
+	
+	// the transitions of the staging world stay valid after the world it was merged into is destroyed
+	{
+		flf::World target{};
+		staging.CreateEntity(Position{8, 0, 0}, Velocity{8, 0, 0});
+		target.Merge(staging);
+		target.DestroyAll<Position>();
+	}
+	std::size_t nTransitions = 0;
+	staging.ForeachTransition([&](const flf::TransitionStats &transition)
+	                          {
+		                          CHECK_EQ(transition.destination, transition.source);
+		                          ++nTransitions;
+	                          });
+	CHECK_GT(nTransitions, 0);
+}
+
+TEST_CASE("World SystemScheduler")
+{
+	flf::World myWorld{};
+	myWorld.DeclareGroup<Position, Velocity>();
+	constexpr int N_ENTITIES = 3000;
+	for (int i = 0; i < N_ENTITIES; ++i)
+	{
+		if (i % 3 == 0)
+		{
+			myWorld.CreateEntity(Position{0, 0, 0}, Velocity{1, 0, 0});
+		} else if (i % 3 == 1)
+		{
+			myWorld.CreateEntity(RedTag{}, Position{0, 0, 0}, Velocity{2, 0, 0}, int(i));
+		} else
+		{
+			myWorld.CreateEntity(Position{0, 0, 0}, int(i));
+		}
+	}
+	
+	flf::SystemScheduler scheduler(myWorld, 3);
+	const std::size_t move = scheduler.AddSystem([](Position &position, const Velocity &velocity) { position.x += velocity.dx; }, 256);
+	const std::size_t scale = scheduler.AddSystem([](Velocity &velocity, RedTag) { velocity.dx *= 2; }, 100);
+	std::atomic<long> sumOfInts{0};
+	const std::size_t readInts = scheduler.AddEntitySystem([&](flf::EntityId, const int &value) { sumOfInts += value; }, 64);
+	std::atomic<int> nMoved{0};
+	const std::size_t countMoved = scheduler.AddSystem([&](const Position &position) { nMoved += position.x > 0 ? 1 : 0; });
+	
+	CHECK(scheduler.GetDependencies(move).empty());
+	CHECK_EQ(scheduler.GetDependencies(scale), std::vector<std::size_t>{move});
+	CHECK(scheduler.GetDependencies(readInts).empty());
+	CHECK_EQ(scheduler.GetDependencies(countMoved), std::vector<std::size_t>{move});
+	
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		sumOfInts = 0;
+		nMoved = 0;
+		scheduler.Run();
+		CHECK_EQ(nMoved.load(), 2 * N_ENTITIES / 3);
+	}
+	
+	long expectedSum = 0;
+	for (int i = 0; i < N_ENTITIES; ++i)
+	{
+		expectedSum += i % 3 != 0 ? i : 0;
+	}
+	CHECK_EQ(sumOfInts.load(), expectedSum);
+	
+	// every frame moves first and doubles the velocity of tagged entities afterwards
+	float sumOfX = 0;
+	myWorld.Foreach([&](const Position &position, RedTag) { sumOfX += position.x; });
+	CHECK_EQ(sumOfX, (2 + 4 + 8) * (N_ENTITIES / 3));
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World double buffered components")
+{
+	flf::World myWorld{};
+	myWorld.DeclareDoubleBuffered<Position>();
+	CHECK(myWorld.IsDoubleBuffered<Position>());
+	CHECK_FALSE(myWorld.IsDoubleBuffered<Velocity>());
+	
+	constexpr int N_ENTITIES = 1000;
+	std::vector<flf::Entity> entities{};
+	for (int i = 0; i < N_ENTITIES; ++i)
+	{
+		entities.push_back(i % 2 == 0 ? myWorld.CreateEntity(Position{0, 0, 0}) : myWorld.CreateEntity(Position{0, 0, 0}, Velocity{1, 0, 0}));
+	}
+	
+	for (int frame = 1; frame <= 3; ++frame)
+	{
+		myWorld.SwapBuffers();
+		
+		// the previous frame is read on another thread while this one writes the current frame
+		const flf::WorldView view(myWorld);
+		float sumOfPrevious = 0;
+		std::thread reader([&]()
+		                   {
+			                   view.ForeachPrevious<Position>([&](flf::EntityId, const Position &position) { sumOfPrevious += position.x; });
+		                   });
+		myWorld.Foreach([frame](Position &position) { position.x = float(frame); });
+		reader.join();
+		
+		CHECK_EQ(sumOfPrevious, float((frame - 1) * N_ENTITIES));
+		CHECK_EQ(view.GetPrevious<Position>(entities[1].Id()).x, float(frame - 1));
+		CHECK_EQ(entities[1].Get<Position>()->x, float(frame));
+	}
+	
+	// entities created after a swap get a row in the vector the next swap hands back
+	const flf::Entity created = myWorld.CreateEntity(Position{0, 0, 0});
+	myWorld.SwapBuffers();
+	CHECK_EQ(myWorld.GetPrevious<Position>(created.Id()).x, 0.f);
+	CHECK_EQ(myWorld.GetPrevious<Position>(entities[0].Id()).x, 3.f);
+	myWorld.Foreach([](Position &position) { position.x = 4; });
+	myWorld.SwapBuffers();
+	CHECK_EQ(myWorld.GetPrevious<Position>(created.Id()).x, 4.f);
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World double buffered accumulation")
+{
+	flf::World myWorld{};
+	myWorld.DeclareDoubleBuffered<Position>();
+	
+	constexpr int N_ENTITIES = 100;
+	std::vector<flf::Entity> entities{};
+	for (int i = 0; i < N_ENTITIES; ++i)
+	{
+		entities.push_back(i % 2 == 0 ? myWorld.CreateEntity(Position{0, 0, 0}) : myWorld.CreateEntity(Position{0, 0, 0}, Velocity{1, 0, 0}));
+	}
+	
+	// the values are accumulated from the previous frame
+	flf::Entity late{};
+	for (int frame = 1; frame <= 5; ++frame)
+	{
+		if (frame == 3)
+		{
+			late = myWorld.CreateEntity(Position{10, 0, 0});
+		}
+		myWorld.ForeachWithPrevious<Position>([](const Position &previous, Position &current)
+		                                      {
+			                                      current = previous;
+			                                      current.x += 1;
+		                                      });
+		CHECK_EQ(entities[0].Get<Position>()->x, float(frame));
+		myWorld.SwapBuffers();
+		
+		CHECK_EQ(myWorld.GetPrevious<Position>(entities[0].Id()).x, float(frame));
+		CHECK_EQ(myWorld.GetPrevious<Position>(entities[1].Id()).x, float(frame));
+	}
+	CHECK_EQ(myWorld.GetPrevious<Position>(late.Id()).x, 13.f);
+	
+	float sum = 0;
+	myWorld.ForeachPrevious<Position>([&](flf::EntityId, const Position &position) { sum += position.x; });
+	CHECK_EQ(sum, float(5 * N_ENTITIES + 13));
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World double buffered components keep their current values")
+{
+	flf::World myWorld{};
+	myWorld.DeclareDoubleBuffered<Position>();
+	flf::Entity entity = myWorld.CreateEntity(Position{0, 0, 0});
+	myWorld.CreateEntity(Position{0, 0, 0}, Velocity{});
+	
+	// components updated in place build on the values of the last frame, not on the ones of two swaps ago
+	for (int frame = 1; frame <= 3; ++frame)
+	{
+		entity.Get<Position>()->x += 1;
+		myWorld.Foreach([](Position &position, const Velocity &) { position.x += 1; });
+		myWorld.SwapBuffers();
+	}
+	CHECK_EQ(entity.Get<Position>()->x, 3.f);
+	CHECK_EQ(myWorld.GetPrevious<Position>(entity.Id()).x, 3.f);
+	
+	float sum = 0;
+	myWorld.Foreach([&](const Position &position) { sum += position.x; });
+	CHECK_EQ(sum, 6.f);
+	myWorld.DestroyAll<Position>();
+}
+
+TEST_CASE("World GetMany")
+{
+	flf::World myWorld{};
+	myWorld.DeclareGroup<Velocity, int>();
+	std::vector<flf::EntityId> ids{};
+	for (int i = 0; i < 300; ++i)
+	{
+		const float value = float(i);
+		if (i % 3 == 0)
+		{
+			ids.push_back(myWorld.CreateEntity(Position{value, 0, 0}).Id());
+		} else if (i % 3 == 1)
+		{
+			ids.push_back(myWorld.CreateEntity(Position{value, 0, 0}, Velocity{value, 0, 0}, int(i)).Id());
+		} else
+		{
+			ids.push_back(myWorld.CreateEntity(RedTag{}, Position{value, 0, 0}).Id());
+		}
+	}
+	// ids in a random order, like the targets referenced by other entities
+	std::reverse(ids.begin() + 100, ids.end());
+	std::swap(ids[3], ids[250]);
+	
+	const std::vector<Position> positions = myWorld.GetMany<Position>(ids);
+	REQUIRE_EQ(positions.size(), ids.size());
+	for (std::size_t i = 0; i < ids.size(); ++i)
+	{
+		CHECK_EQ(positions[i].x, myWorld.GetEntity(ids[i]).Get<Position>()->x);
+	}
+	
+	// grouped components
+	const flf::EntityId withVelocity[] = {ids[1], ids[4], ids[7]};
+	Velocity velocities[3];
+	myWorld.GetMany(withVelocity, 3, velocities);
+	CHECK_EQ(velocities[0].dx, 1.f);
+	CHECK_EQ(velocities[1].dx, 4.f);
+	CHECK_EQ(velocities[2].dx, 7.f);
+	myWorld.DestroyAll<Position>();
+}